@@ -2,6 +2,8 @@
 #include "Untest.h"
 #include "UntestModule.h"
 
+#include "Algo/Find.h"
+
 DEFINE_LOG_CATEGORY_STATIC(LogUntestRunTestsCommandlet, Display, All);
 
 struct FUntestRunTestsCommandletOptions
@@ -10,6 +12,16 @@ struct FUntestRunTestsCommandletOptions
 	FString ReportPath;
 	bool bNoTimeouts = false;
 	bool bIncludeDisabled = false;
+	float TimeoutScale = 0.0f;
+	EUntestTimeoutClock TimeoutClock = EUntestTimeoutClock::Wall;
+	bool bReuseWorlds = true;
+	bool bPipelineSetup = true;
+	EUntestGCPolicy GCPolicy = EUntestGCPolicy::EveryTest;
+	int32 GCInterval = 8;
+	float GCMemoryThresholdMB = 512.0f;
+	float GCPurgeBudgetMs = 2.0f;
+	int32 MaxConcurrentNetTests = 1;
+	bool bCompareReplicationSystems = false;
 
 	static FUntestRunTestsCommandletOptions FromParams(const FString& Params)
 	{
@@ -41,6 +53,77 @@ struct FUntestRunTestsCommandletOptions
 			Options.bIncludeDisabled = true;
 		}
 
+		if (Switches.Contains(TEXT("NoWorldReuse")))
+		{
+			Options.bReuseWorlds = false;
+		}
+
+		if (Switches.Contains(TEXT("NoPipelineSetup")))
+		{
+			Options.bPipelineSetup = false;
+		}
+
+		if (FString* TimeoutScale = SwitchParams.Find(TEXT("TimeoutScale")))
+		{
+			LexFromString(Options.TimeoutScale, **TimeoutScale);
+		}
+
+		if (FString* TimeoutClock = SwitchParams.Find(TEXT("TimeoutClock")))
+		{
+			if (TimeoutClock->Equals(TEXT("Cpu"), ESearchCase::IgnoreCase))
+			{
+				Options.TimeoutClock = EUntestTimeoutClock::ThreadCpu;
+			}
+			else if (TimeoutClock->Equals(TEXT("Wall"), ESearchCase::IgnoreCase) == false)
+			{
+				UE_LOG(LogUntestRunTestsCommandlet, Warning, TEXT("Unknown -TimeoutClock '%s', expected Wall or Cpu. Using Wall."), **TimeoutClock);
+			}
+		}
+
+		if (FString* GCPolicy = SwitchParams.Find(TEXT("GCPolicy")))
+		{
+			const EUntestGCPolicy Policies[] = { EUntestGCPolicy::EveryTest, EUntestGCPolicy::EveryNTests, EUntestGCPolicy::MemoryThreshold, EUntestGCPolicy::Incremental };
+			const EUntestGCPolicy* Policy = Algo::FindByPredicate(Policies, [GCPolicy](EUntestGCPolicy Policy)
+				{
+					return GCPolicy->Equals(UntestGCPolicyStr(Policy), ESearchCase::IgnoreCase);
+				});
+
+			if (Policy)
+			{
+				Options.GCPolicy = *Policy;
+			}
+			else
+			{
+				UE_LOG(LogUntestRunTestsCommandlet, Warning, TEXT("Unknown -GCPolicy '%s', expected EveryTest, EveryNTests, MemoryThreshold or Incremental. Using EveryTest."), **GCPolicy);
+			}
+		}
+
+		if (FString* GCInterval = SwitchParams.Find(TEXT("GCInterval")))
+		{
+			LexFromString(Options.GCInterval, **GCInterval);
+		}
+
+		if (FString* GCMemoryThresholdMB = SwitchParams.Find(TEXT("GCMemoryThresholdMB")))
+		{
+			LexFromString(Options.GCMemoryThresholdMB, **GCMemoryThresholdMB);
+		}
+
+		if (FString* GCPurgeBudgetMs = SwitchParams.Find(TEXT("GCPurgeBudgetMs")))
+		{
+			LexFromString(Options.GCPurgeBudgetMs, **GCPurgeBudgetMs);
+		}
+
+		if (FString* MaxConcurrentNetTests = SwitchParams.Find(TEXT("MaxConcurrentNetTests")))
+		{
+			LexFromString(Options.MaxConcurrentNetTests, **MaxConcurrentNetTests);
+			Options.MaxConcurrentNetTests = FMath::Max(Options.MaxConcurrentNetTests, 1);
+		}
+
+		if (Switches.Contains(TEXT("CompareIris")))
+		{
+			Options.bCompareReplicationSystems = true;
+		}
+
 		return Options;
 	}
 };
@@ -77,15 +160,39 @@ int32 UUntestRunTestsCommandlet::Main(const FString& Params)
 			UE_LOG(LogUntestRunTestsCommandlet, Display, TEXT("Running test: %s"), *TestName.ToFull());
 		});
 
-	auto OnTestCompleteDelegate = FBVOnTestComplete::CreateLambda([](const FUntestResults& Results)
+	auto GetDisplayName = [](const FUntestResults& Results)
+	{
+		FString DisplayName = Results.TestName.ToFull();
+		if (Results.ReplicationSystem != EUntestReplicationSystem::Default)
+		{
+			DisplayName += FString::Printf(TEXT(" [%s]"), UntestReplicationSystemStr(Results.ReplicationSystem));
+		}
+		return DisplayName;
+	};
+
+	auto OnTestCompleteDelegate = FBVOnTestComplete::CreateLambda([GetDisplayName](const FUntestResults& Results)
 		{
 			if (Results.Errors.IsEmpty())
 			{
-				UE_LOG(LogUntestRunTestsCommandlet, Display, TEXT("%s succeeded (%.2fms)"), *Results.TestName.ToFull(), Results.DurationMs);
+				UE_LOG(LogUntestRunTestsCommandlet, Display, TEXT("%s succeeded (%.2fms, %.2fms cpu)"), *GetDisplayName(Results), Results.DurationMs, Results.CpuDurationMs);
+				for (const FUntestMetric& Metric : Results.Metrics)
+				{
+					UE_LOG(LogUntestRunTestsCommandlet, Display, TEXT("    %s: %.4f"), *Metric.Name, Metric.Value);
+				}
+				if (Results.NetStats.IsValid())
+				{
+					const FUntestNetStats& Net = Results.NetStats;
+					UE_LOG(LogUntestRunTestsCommandlet, Display, TEXT("    Net: %.0f B/s out, %.0f B/s in, %.1f actors/frame, %.3fms replicating/frame"),
+						Net.GetOutBytesPerSecond(), Net.GetInBytesPerSecond(), Net.GetAvgReplicatedActorsPerFrame(), Net.GetAvgReplicateActorsMsPerFrame());
+					if (Net.RttSamples > 0)
+					{
+						UE_LOG(LogUntestRunTestsCommandlet, Display, TEXT("    Net: %.1fms avg rtt, %.1fms max rtt"), Net.AvgRttMs, Net.MaxRttMs);
+					}
+				}
 			}
 			else
 			{
-				UE_LOG(LogUntestRunTestsCommandlet, Error, TEXT("%s failed. Errors:"), *Results.TestName.ToFull());
+				UE_LOG(LogUntestRunTestsCommandlet, Error, TEXT("%s failed. Errors:"), *GetDisplayName(Results));
 				for (const FString& Error : Results.Errors)
 				{
 					UE_LOG(LogUntestRunTestsCommandlet, Error, TEXT("%s"), *Error);
@@ -106,6 +213,22 @@ int32 UUntestRunTestsCommandlet::Main(const FString& Params)
 				NumFailed += (Results.Errors.Num() > 0) ? 1 : 0;
 			}
 
+			const TArray<FUntestReplicationComparison> Comparisons = UntestCompareReplicationSystems(AllResults);
+			if (Comparisons.Num() > 0)
+			{
+				UE_LOG(LogUntestRunTestsCommandlet, Display, TEXT("Iris vs generic replication (ratios are Iris / generic):"));
+				for (const FUntestReplicationComparison& Comparison : Comparisons)
+				{
+					UE_LOG(LogUntestRunTestsCommandlet, Display, TEXT("    %s: %.2fx bandwidth, %.2fx replication ms/frame, %s / %s"),
+						*Comparison.Iris->TestName.ToFull(), Comparison.GetOutBytesRatio(), Comparison.GetReplicateMsRatio(),
+						UntestResultStr(Comparison.Generic->Result), UntestResultStr(Comparison.Iris->Result));
+					if (Comparison.HaveSameResult() == false)
+					{
+						UE_LOG(LogUntestRunTestsCommandlet, Warning, TEXT("    %s has a different result with each replication system"), *Comparison.Iris->TestName.ToFull());
+					}
+				}
+			}
+
 			if (NumFailed == 0)
 			{
 				UE_LOG(LogUntestRunTestsCommandlet, Display, TEXT("Test run finished. %d / %d tests succeeded."), NumTests, NumTests);
@@ -122,6 +245,16 @@ int32 UUntestRunTestsCommandlet::Main(const FString& Params)
 	FUntestRunOpts RunOpts;
 	RunOpts.bNoTimeouts = RunOptions.bNoTimeouts;
 	RunOpts.bIncludeDisabled = RunOptions.bIncludeDisabled;
+	RunOpts.TimeoutScale = RunOptions.TimeoutScale;
+	RunOpts.TimeoutClock = RunOptions.TimeoutClock;
+	RunOpts.bReuseWorlds = RunOptions.bReuseWorlds;
+	RunOpts.bPipelineSetup = RunOptions.bPipelineSetup;
+	RunOpts.GCPolicy = RunOptions.GCPolicy;
+	RunOpts.GCInterval = RunOptions.GCInterval;
+	RunOpts.GCMemoryThresholdMB = RunOptions.GCMemoryThresholdMB;
+	RunOpts.GCPurgeBudgetMs = RunOptions.GCPurgeBudgetMs;
+	RunOpts.MaxConcurrentNetTests = RunOptions.MaxConcurrentNetTests;
+	RunOpts.bCompareReplicationSystems = RunOptions.bCompareReplicationSystems;
 	RunOpts.OnTestStarted = OnTestStartedDelegate;
 	RunOpts.OnTestComplete = OnTestCompleteDelegate;
 	RunOpts.OnAllTestsComplete = OnAllTestsCompleteDelegate;
@@ -131,6 +264,8 @@ int32 UUntestRunTestsCommandlet::Main(const FString& Params)
 		return 1;
 	}
 
+	UE_LOG(LogUntestRunTestsCommandlet, Display, TEXT("Test timeouts scaled by %.2f."), Module.GetTimeoutScale());
+
 	while (bAreTestsRunning)
 	{
 		CommandletHelpers::TickEngine();
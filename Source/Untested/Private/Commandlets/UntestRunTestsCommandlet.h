@@ -7,7 +7,9 @@
 //
 // Usage:
 //
-//   UnrealEditor-Cmd.exe <PathToUProject> -run=UntestRunTests [-Name=<FullOrPartialName>] [-ReportPath=<Path>] [-NoTimeout]
+//   UnrealEditor-Cmd.exe <PathToUProject> -run=UntestRunTests [-Name=<FullOrPartialName>] [-ReportPath=<Path>] [-NoTimeout] [-TimeoutScale=<Scale>] [-TimeoutClock=<Wall|Cpu>] [-NoWorldReuse] [-NoPipelineSetup]
+//       [-GCPolicy=<EveryTest|EveryNTests|MemoryThreshold|Incremental>] [-GCInterval=<N>] [-GCMemoryThresholdMB=<MB>] [-GCPurgeBudgetMs=<Ms>]
+//       [-MaxConcurrentNetTests=<N>] [-CompareIris]
 //
 // Arguments:
 //
@@ -27,6 +29,53 @@
 //       cloud build machines that get timesliced inconsistently don't fail tests for timing
 //       out too early.
 //
+//   -TimeoutScale: Optional. Multiplier applied to every test timeout. By default the scale is
+//       calibrated at the start of the run by timing a short fixed CPU workload, so slower or
+//       loaded machines get proportionally longer timeouts. The scale used is recorded in the
+//       report. For example:
+//           -TimeoutScale=1.0
+//           -TimeoutScale=4
+//
+//   -TimeoutClock: Optional. Selects the clock timeouts are checked against. Wall (the default)
+//       measures real time since the test started. Cpu measures only the thread CPU time spent
+//       while the test itself was running, so time spent waiting on other concurrently running
+//       tests doesn't count against it. Both times are recorded in the report.
+//
+//   -NoWorldReuse: Optional. World tests normally run in pooled worlds, and ClientServer tests in
+//       pooled, already connected server/client pairs, that are reset between tests. A reset destroys
+//       what the test spawned and clears timers, but BeginPlay isn't run again and property changes to
+//       the world settings and other actors the test didn't spawn carry over to the next test. Use this
+//       to create and destroy fresh worlds for every test instead.
+//
+//   -NoPipelineSetup: Optional. Consecutive World tests normally overlap: the next test sets up
+//       its world while the current one runs, then waits for it to finish before running itself,
+//       and the wait doesn't count against its timeout. Pipelining pauses whenever a garbage
+//       collection is due. Use this to set up each test only once the previous one has finished.
+//
+//   -GCPolicy: Optional. Controls how often garbage left behind by destroyed test worlds is
+//       collected. Collections only run between tests, and every destroyed world, game instance
+//       and package is checked after the collection that should have freed it, failing the test
+//       that leaked it. Policies:
+//           EveryTest: a full collection after every test that destroyed a world (the default)
+//           EveryNTests: a full collection once -GCInterval tests have destroyed worlds (default 8)
+//           MemoryThreshold: a full collection once used memory has grown by -GCMemoryThresholdMB
+//               since the last one (default 512)
+//           Incremental: reachability analysis after every test that destroyed a world, with
+//               purging spread across ticks in slices of -GCPurgeBudgetMs (default 2)
+//       A final full collection always runs at the end of the test run.
+//
+//   -MaxConcurrentNetTests: Optional. Number of consecutive ClientServer tests that may run at
+//       the same time. Each test's server listens on its own port, so their connections don't
+//       interfere. ClientServer tests connect through an in-memory loopback NetDriver unless the
+//       fixture picks another one, in which case the port is assigned by the OS. Defaults to 1. For example:
+//           -MaxConcurrentNetTests=4
+//
+//   -CompareIris: Optional. Runs every ClientServer test twice: once with the generic replication
+//       system, then again with Iris once all other tests are done. Both runs are in the report,
+//       named "<Test> [Generic]" and "<Test> [Iris]", and the Iris run has IrisVsGeneric.*
+//       properties comparing bandwidth, server replication time and the test result. The engine
+//       must be built with Iris.
+//
 UCLASS()
 class UUntestRunTestsCommandlet : public UCommandlet
 {
@@ -0,0 +1,79 @@
+#include "UntestServeCommandlet.h"
+#include "Untest.h"
+#include "UntestDedicatedServer.h"
+#include "UntestModule.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogUntestServeCommandlet, Display, All);
+
+int32 UUntestServeCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> SwitchParams;
+	UCommandlet::ParseCommandLine(*Params, Tokens, Switches, SwitchParams);
+
+	const FString* TestName = SwitchParams.Find(TEXT("Test"));
+	const FString* ControlPortStr = SwitchParams.Find(TEXT("ControlPort"));
+	uint16 ControlPort = 0;
+	if (ControlPortStr)
+	{
+		LexFromString(ControlPort, **ControlPortStr);
+	}
+	if (TestName == nullptr || ControlPort == 0)
+	{
+		UE_LOG(LogUntestServeCommandlet, Error, TEXT("Expected -Test=<FullTestName> and -ControlPort=<Port>."));
+		return 1;
+	}
+
+	EUntestReplicationSystem ReplicationSystem = EUntestReplicationSystem::Default;
+	if (const FString* ReplicationSystemStr = SwitchParams.Find(TEXT("ReplicationSystem")))
+	{
+		for (EUntestReplicationSystem System : { EUntestReplicationSystem::Generic, EUntestReplicationSystem::Iris })
+		{
+			if (ReplicationSystemStr->Equals(UntestReplicationSystemStr(System), ESearchCase::IgnoreCase))
+			{
+				ReplicationSystem = System;
+			}
+		}
+	}
+
+	FUntestModule& Module = FUntestModule::Get();
+
+	FUntestSearchFilter Filter;
+	Filter.SearchName = *TestName;
+	Filter.Types = EUntestTypeFlags::ClientServer;
+	const bool bIsClientServerTest = Module.FindTests(Filter).ContainsByPredicate([TestName](const FUntestInfo& Info)
+		{
+			return Info.Name.ToFull() == *TestName;
+		});
+
+	TSharedPtr<FUntestFixture> Fixture = bIsClientServerTest ? Module.NewFixture(*TestName, ReplicationSystem) : nullptr;
+	if (Fixture.IsValid() == false)
+	{
+		UE_LOG(LogUntestServeCommandlet, Error, TEXT("No ClientServer test named '%s'."), **TestName);
+		return 1;
+	}
+
+	// Only started by FUntestDedicatedServerTestFixture, for its own tests
+	FUntestDedicatedServerTestFixture* ServerFixture = Fixture->AsDedicatedServerFixture();
+	if (ServerFixture == nullptr)
+	{
+		UE_LOG(LogUntestServeCommandlet, Error, TEXT("'%s' doesn't use a FUntestDedicatedServerTestFixture, so it has no server to serve."), **TestName);
+		return 1;
+	}
+
+	UE_LOG(LogUntestServeCommandlet, Display, TEXT("Serving %s for the fixture on port %hu."), **TestName, ControlPort);
+
+	UntestTask Task = ServerFixture->ServeFixture(**TestName, ControlPort);
+	while (Task.IsDone() == false)
+	{
+		CommandletHelpers::TickEngine();
+		Task.Resume();
+
+		// Dedicated servers sleep between ticks instead of spinning, which leaves the clients' process its cores
+		FPlatformProcess::SleepNoStats(0.001f);
+	}
+
+	// The test's errors went to the fixture, which fails the test for them
+	return 0;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "UntestServeCommandlet.generated.h"
+
+// This commandlet runs the server half of a test written with FUntestDedicatedServerTestFixture. The fixture starts it
+// for every test and talks to it over the control port, so it isn't meant to be run by hand.
+//
+// Usage:
+//
+//   UnrealEditor-Cmd.exe <PathToUProject> -run=UntestServe -Test=<FullTestName> -ControlPort=<Port> [-ReplicationSystem=<Generic|Iris>]
+//
+// Arguments:
+//
+//   -Test: Fully-qualified name of the test to serve.
+//
+//   -ControlPort: Loopback port the fixture is waiting for the server process on.
+//
+//   -ReplicationSystem: Optional. Set when the test run compares replication systems, so the test can see which one it
+//       runs with. The fixture also passes the matching net.Iris.UseIrisReplication setting.
+//
+UCLASS()
+class UUntestServeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+	virtual int32 Main(const FString& Params) override;
+};
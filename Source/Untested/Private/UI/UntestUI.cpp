@@ -442,6 +442,7 @@ struct FUntestRunnerOptions
 {
 	bool bIsTimeoutEnabled = true;
 	bool bIncludeDisabled = false;
+	bool bUseCpuTimeouts = false;
 };
 
 class SUntestRunner : public SCompoundWidget
@@ -467,6 +468,8 @@ private:
 	void OnTimeoutCheckStateChanged(ECheckBoxState CheckBoxState);
 	ECheckBoxState IncludeDisabled() const;
 	void OnIncludeDisabledCheckStateChanged(ECheckBoxState CheckBoxState);
+	ECheckBoxState UseCpuTimeouts() const;
+	void OnUseCpuTimeoutsCheckStateChanged(ECheckBoxState CheckBoxState);
 	FText GetTestResultsText() const;
 	FText GetStatusText() const;
 	EVisibility StatusProgressVisibility() const;
@@ -698,6 +701,23 @@ void SUntestRunner::Construct(const FArguments& InArgs)
 													.Text(LOCTEXT("Untest.Options.IncludeDisabled.Label", "Include Disabled Tests"))
 												]
 											]
+
+											+SVerticalBox::Slot()
+											.Padding(FMargin(4.0f, 4.0f))
+											.AutoHeight()
+											[
+												SNew(SCheckBox)
+												.IsChecked(this, &SUntestRunner::UseCpuTimeouts)
+												.OnCheckStateChanged(this, &SUntestRunner::OnUseCpuTimeoutsCheckStateChanged)
+												.Padding(FMargin(4.0f, 0.0f))
+												.ToolTipText(LOCTEXT("Untest.Options.CpuTimeouts.Tooltip", "Check timeouts against the CPU time spent running each test instead of wall clock time."))
+												.IsEnabled( this, &SUntestRunner::AreNoTestsRunning )
+												.Content()
+												[
+													SNew(STextBlock)
+													.Text(LOCTEXT("Untest.Options.CpuTimeouts.Label", "CPU Time Timeouts"))
+												]
+											]
 										]
 									]
 
@@ -1025,6 +1045,7 @@ FReply SUntestRunner::RunOrAbortTests()
 		FUntestRunOpts RunOpts;
 		RunOpts.bNoTimeouts = Options.bIsTimeoutEnabled == false;
 		RunOpts.bIncludeDisabled = Options.bIncludeDisabled;
+		RunOpts.TimeoutClock = Options.bUseCpuTimeouts ? EUntestTimeoutClock::ThreadCpu : EUntestTimeoutClock::Wall;
 		RunOpts.OnTestComplete = OnTestCompleteDelegate;
 		RunOpts.OnAllTestsComplete = OnAllTestsCompleteDelegate;
 		Module.QueueTests(TestNames, RunOpts);
@@ -1135,6 +1156,16 @@ void SUntestRunner::OnIncludeDisabledCheckStateChanged(ECheckBoxState CheckBoxSt
 	Options.bIncludeDisabled = CheckBoxState != ECheckBoxState::Unchecked;
 }
 
+ECheckBoxState SUntestRunner::UseCpuTimeouts() const
+{
+	return Options.bUseCpuTimeouts ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+}
+
+void SUntestRunner::OnUseCpuTimeoutsCheckStateChanged(ECheckBoxState CheckBoxState)
+{
+	Options.bUseCpuTimeouts = CheckBoxState != ECheckBoxState::Unchecked;
+}
+
 FText SUntestRunner::GetTestResultsText() const
 {
 	int32 NumTestsWithResults = 0;
@@ -1147,7 +1178,7 @@ FText SUntestRunner::GetTestResultsText() const
 			++NumTestsWithResults;
 
 			const TCHAR* ResultStr = UntestResultStr(Test->Results->Result);
-			TextBuilder.Appendf(TEXT("%s: %s\n"), *Test->Name, ResultStr);
+			TextBuilder.Appendf(TEXT("%s: %s (%.2fms, %.2fms cpu)\n"), *Test->Name, ResultStr, Test->Results->DurationMs, Test->Results->CpuDurationMs);
 
 			for (const FString& Error : Test->Results->Errors)
 			{
@@ -1190,6 +1221,7 @@ void SUntestRunner::OnTestComplete(const FUntestResults& Results)
 				Parent->Results = FUntestResults();
 			}
 			Parent->Results->DurationMs += Test->Results->DurationMs;
+			Parent->Results->CpuDurationMs += Test->Results->CpuDurationMs;
 			Parent->Results->Errors.Append(Test->Results->Errors);
 		}
 	}
@@ -1,14 +1,26 @@
 #include "Untest.h"
+#include "UntestGarbageCollector.h"
+#include "UntestLoopbackNetDriver.h"
+#include "UntestMapPreloader.h"
 #include "UntestModule.h"
+#include "UntestReplicationAudit.h"
+#include "UntestReplicationGraphProbe.h"
+#include "UntestWorldPool.h"
 
 #include "Editor.h"
 #include "Editor/UnrealEdEngine.h"
+#include "Engine/LevelStreamingDynamic.h"
 #include "Engine/LocalPlayer.h"
+#include "Engine/NetConnection.h"
 #include "Engine/NetDriver.h"
+#include "Engine/PendingNetGame.h"
+#include "Engine/ReplicationDriver.h"
 #include "EngineUtils.h"
 #include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerController.h"
 #include "GameFramework/WorldSettings.h"
-#include "Settings/LevelEditorPlaySettings.h"
+#include "IPAddress.h"
+#include "PacketHandler.h"
 #include "UnrealEdGlobals.h"
 
 DEFINE_LOG_CATEGORY(LogUntest);
@@ -17,6 +29,88 @@ DEFINE_LOG_CATEGORY(LogUntest);
 	return TestName;                                                              \
 })
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FUntestContext
+
+void FUntestContext::SetNetProfile(const FUntestNetProfile& Profile)
+{
+	NetProfile = Profile;
+
+	for (const TWeakObjectPtr<UWorld>& World : Worlds)
+	{
+		UNetDriver* NetDriver = World.IsValid() ? World->GetNetDriver() : nullptr;
+		if (NetDriver == nullptr)
+		{
+			continue;
+		}
+
+		// The loopback driver reorders by percentage itself, the engine's simulation can only shuffle everything
+		UUntestLoopbackNetDriver* LoopbackNetDriver = Cast<UUntestLoopbackNetDriver>(NetDriver);
+		if (LoopbackNetDriver)
+		{
+			LoopbackNetDriver->SetReorderPercent(Profile.ReorderPercent);
+		}
+
+#if DO_ENABLE_NET_TEST
+		FPacketSimulationSettings Settings;
+		Settings.PktLag = Profile.LatencyMs;
+		Settings.PktLagVariance = Profile.JitterMs;
+		Settings.PktLoss = Profile.LossPercent;
+		Settings.PktDup = Profile.DuplicatePercent;
+		Settings.PktOrder = (LoopbackNetDriver == nullptr && Profile.ReorderPercent > 0) ? 1 : 0;
+		NetDriver->SetPacketSimulationSettings(Settings);
+#else
+		// The loopback driver relies on the engine's packet simulation for everything but reordering as well
+		const bool bNeedsPacketSimulation = Profile.LatencyMs > 0 || Profile.JitterMs > 0 || Profile.LossPercent > 0 || Profile.DuplicatePercent > 0
+			|| (Profile.ReorderPercent > 0 && LoopbackNetDriver == nullptr);
+		if (bNeedsPacketSimulation)
+		{
+			AddError(TEXT("Network profiles need packet simulation, which isn't compiled into this build. Only reordering with the loopback NetDriver works without it."));
+			return;
+		}
+#endif
+	}
+}
+
+void FUntestContext::MarkLatencySend(const FString& Key)
+{
+	// Later sends with the same key replace earlier ones, but arrivals don't consume them, so every client receiving
+	// a multicast measures against the same send
+	FLatencySend& Send = LatencySends.FindOrAdd(Key);
+	Send.FrameNumber = FrameNumber;
+	Send.Timestamp = FPlatformTime::Seconds();
+}
+
+Squid::Task<FUntestLatency> FUntestContext::WaitForLatency(FString Key, TFunction<bool()> HasArrived)
+{
+	co_await Squid::WaitUntil([this, &Key, &HasArrived]()
+		{
+			return LatencySends.Contains(Key) && HasArrived();
+		});
+
+	const FLatencySend& Send = LatencySends[Key];
+	FUntestLatency Latency;
+	Latency.Ticks = FrameNumber - Send.FrameNumber;
+	Latency.Ms = (FPlatformTime::Seconds() - Send.Timestamp) * 1000.0;
+
+	FLatencyStats& Stats = LatencyStats.FindOrAdd(Key);
+	Stats.MinMs = (Stats.Count == 0) ? Latency.Ms : FMath::Min(Stats.MinMs, Latency.Ms);
+	Stats.MaxMs = FMath::Max(Stats.MaxMs, Latency.Ms);
+	Stats.TotalMs += Latency.Ms;
+	Stats.MaxTicks = FMath::Max(Stats.MaxTicks, Latency.Ticks);
+	Stats.TotalTicks += Latency.Ticks;
+	++Stats.Count;
+
+	AddMetric(FString::Printf(TEXT("Latency.%s.Count"), *Key), Stats.Count);
+	AddMetric(FString::Printf(TEXT("Latency.%s.Ms.Avg"), *Key), Stats.TotalMs / Stats.Count);
+	AddMetric(FString::Printf(TEXT("Latency.%s.Ms.Min"), *Key), Stats.MinMs);
+	AddMetric(FString::Printf(TEXT("Latency.%s.Ms.Max"), *Key), Stats.MaxMs);
+	AddMetric(FString::Printf(TEXT("Latency.%s.Ticks.Avg"), *Key), static_cast<double>(Stats.TotalTicks) / Stats.Count);
+	AddMetric(FString::Printf(TEXT("Latency.%s.Ticks.Max"), *Key), Stats.MaxTicks);
+
+	co_return Latency;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // FUntestFixtureFactory
 
@@ -37,6 +131,29 @@ FUntestFixtureFactory::~FUntestFixtureFactory()
 	FUntestModule::UnregisterFixture(*this);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FUntestSuite
+
+UntestTask FUntestSuite::Setup(FUntestContext& TestContext)
+{
+	return UntestTask();
+}
+
+void FUntestSuite::Teardown()
+{
+}
+
+FUntestSuiteFactory::FUntestSuiteFactory(FString InModuleName, FString InCategoryName)
+	: Name(FString::Printf(TEXT("%s.%s"), *InModuleName, *InCategoryName))
+{
+	FUntestModule::RegisterSuite(*this);
+}
+
+FUntestSuiteFactory::~FUntestSuiteFactory()
+{
+	FUntestModule::UnregisterSuite(*this);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // FUntestFixture
 
@@ -94,52 +211,62 @@ UntestTask FBVWorldTestFixture::SetupFixture(const FString TestName)
 
 	FUntestContext& TestContext = GetContext();
 
-	const FString PackageName = FString::Printf(TEXT("/Untest/TestPackage_%s"), *TestName);
-	UPackage* Package = NewObject<UPackage>(nullptr, *PackageName);
-	Package->AddToRoot();
-	Package->MarkAsFullyLoaded();
-	TestContext.Packages[EUntestWorldType::Server] = Package;
-
-	const FString GameInstanceName = FString::Printf(TEXT("UntestGameInstance_%s"), *TestName);
+	// Waits for the map's content without blocking, so creating the world below only has to instance it
+	const FString MapPackageName = TestContext.GetMapPackageName();
+	if (MapPackageName.IsEmpty() == false)
+	{
+		const bool bMapLoaded = co_await FUntestMapPreloader::Get().WaitUntilLoaded(MapPackageName, TestContext);
+		if (bMapLoaded == false)
+		{
+			co_return;
+		}
+	}
 
-	UUntestGameInstance* GameInstance = CastChecked<UUntestGameInstance>(NewObject<UUntestGameInstance>(GetTransientPackage(), *GameInstanceName));
-	TestContext.GameInstances[EUntestWorldType::Server] = GameInstance;
+	// A pipelined test's snapshotted world is usually still in use by the test ahead of it. Waiting for it to be released
+	// is far cheaper than creating a second world and running Setup() again.
+	const FString SnapshotKey = GetSnapshotKey();
+	if (SnapshotKey.IsEmpty() == false && TestContext.RunAfterTask.IsDone() == false)
+	{
+		const double WaitBegin = FPlatformTime::Seconds();
+		TestContext.bWaitingToRun = true;
+		co_await Squid::WaitUntil([&TestContext]()
+			{
+				return TestContext.RunAfterTask.IsDone();
+			});
+		TestContext.bWaitingToRun = false;
+		TestContext.TimestampBegin += FPlatformTime::Seconds() - WaitBegin;
+	}
 
-	const bool bInformEngineOfWorld = false;
-	const bool bAddToRoot = false;
-	const bool bSkipInitWorld = true;
-	const FString WorldName = FString::Printf(TEXT("UntestWorld_%s"), *TestName);
-	UWorld* World = UWorld::CreateWorld(EWorldType::PIE, bInformEngineOfWorld, *WorldName, Package, bAddToRoot, ERHIFeatureLevel::Num, nullptr, bSkipInitWorld);
-	if (World == nullptr)
+	// Pooled worlds are created once and reset between tests instead of being rebuilt for each one
+	FUntestPooledWorld PooledWorld;
+	FString Error;
+	const double AcquireBegin = FPlatformTime::Seconds();
+	if (FUntestWorldPool::Get().Acquire(GetWorldPoolKey(), GetWorldProfile(), MapPackageName, SnapshotKey, TestName, PooledWorld, Error) == false)
 	{
-		TestContext.AddError(TEXT("Failed to create test world"));
+		TestContext.AddError(Error);
 		co_return;
 	}
-	TestContext.Worlds[EUntestWorldType::Server] = World;
+	TestContext.AddMetric(TEXT("WorldSetupMs"), (FPlatformTime::Seconds() - AcquireBegin) * 1000.0);
 
-	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
-	WorldContext.RunAsDedicated = true;
-	WorldContext.OwningGameInstance = GameInstance;
-	WorldContext.SetCurrentWorld(World);
+	TestContext.Packages[EUntestWorldType::Server] = PooledWorld.Package;
+	TestContext.GameInstances[EUntestWorldType::Server] = PooledWorld.GameInstance;
+	TestContext.Worlds[EUntestWorldType::Server] = PooledWorld.World;
 
-	GameInstance->SetWorldContext(&WorldContext);
-	GameInstance->Init();
-	GameInstance->ClearFlags(RF_Standalone);
-	GameInstance->AddToRoot();
-
-	World->SetGameInstance(GameInstance);
-	World->InitWorld();
-	World->SetPlayInEditorInitialNetMode(NM_DedicatedServer);
-	World->InitializeActorsForPlay(FURL());
-	if (IsValid(World->GetWorldSettings()))
+	// A world restored from a snapshot is already in the state Setup() left the first test's world in
+	if (PooledWorld.Snapshot.IsValid())
 	{
-		// Need to do this manually since world doesn't have a game mode
-		World->GetWorldSettings()->NotifyBeginPlay();
-		World->GetWorldSettings()->NotifyMatchStarted();
+		OnRestoredFromSnapshot(TestContext);
+		co_return;
 	}
-	World->BeginPlay();
 
+	const double SetupBegin = FPlatformTime::Seconds();
 	co_await Setup(TestContext);
+	TestContext.AddMetric(TEXT("FixtureSetupMs"), (FPlatformTime::Seconds() - SetupBegin) * 1000.0);
+
+	if (SnapshotKey.IsEmpty() == false && TestContext.Errors.IsEmpty())
+	{
+		FUntestWorldPool::Get().TakeSnapshot(PooledWorld.World.Get());
+	}
 }
 
 UntestTask FBVWorldTestFixture::RunFixture(const FString TestName)
@@ -159,6 +286,7 @@ UntestTask FBVWorldTestFixture::RunFixture(const FString TestName)
 
 		FUntestContext& TestContext = GetContext();
 
+		++TestContext.FrameNumber;
 		TestContext.Worlds[EUntestWorldType::Server]->Tick(LEVELTICK_All, DeltaSeconds);
 		Task.Resume();
 
@@ -175,13 +303,52 @@ UntestTask FBVWorldTestFixture::TeardownFixture(const FString TestName)
 	FUntestContext& TestContext = GetContext();
 	co_await Teardown(TestContext);
 
-	TeardownWorld();
+	DestroyTestObjects();
+
+	if (UWorld* World = TestContext.Worlds[EUntestWorldType::Server].Get())
+	{
+		if (CanReuseWorld())
+		{
+			FUntestWorldPool::Get().Release(World);
+		}
+		else
+		{
+			FUntestWorldPool::Get().Discard(World);
+		}
+	}
+
+	TestContext.Worlds[EUntestWorldType::Server].Reset();
+	TestContext.GameInstances[EUntestWorldType::Server].Reset();
+	TestContext.Packages[EUntestWorldType::Server].Reset();
 }
 
 void FBVWorldTestFixture::TeardownWorld()
 {
 	FUntestContext& TestContext = GetContext();
 
+	DestroyTestObjects();
+
+	// Only reached without a normal teardown (e.g. the test timed out), so the world is in an unknown state and
+	// shouldn't be reused
+	if (UWorld* World = TestContext.Worlds[EUntestWorldType::Server].Get())
+	{
+		FUntestWorldPool::Get().Discard(World);
+	}
+
+	TestContext.Worlds[EUntestWorldType::Server].Reset();
+	TestContext.GameInstances[EUntestWorldType::Server].Reset();
+	TestContext.Packages[EUntestWorldType::Server].Reset();
+}
+
+void FBVWorldTestFixture::DestroyTestObjects()
+{
+	FUntestContext& TestContext = GetContext();
+
+	if (TestContext.Objects.Num() > 0)
+	{
+		FUntestGarbageCollector::Get().AddUntrackedGarbage();
+	}
+
 	for (TWeakObjectPtr<UObject> ObjPtr : TestContext.Objects)
 	{
 		if (UObject* Obj = ObjPtr.Get())
@@ -189,49 +356,242 @@ void FBVWorldTestFixture::TeardownWorld()
 			Obj->ConditionalBeginDestroy();
 		}
 	}
+	TestContext.Objects.Reset();
+}
 
-	// See https://minifloppy.it/posts/2024/automated-testing-specs-ue5/#uworld-fixture
-	if (UWorld* World = TestContext.Worlds[EUntestWorldType::Server].Get())
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FBVClientServerTestFixture
+
+// Streams the test's map into one of a ClientServer test's worlds. Every side loads it with the same level name, and the
+// world's PIE prefix keeps their packages apart and gets them remapped for replication, like the worlds' own packages.
+static Squid::Task<bool> LoadClientServerMap(FUntestContext& TestContext, UWorld* World, const FString& LevelName)
+{
+	const FString& MapPackageName = TestContext.GetMapPackageName();
+	ULevelStreamingDynamic* StreamingLevel = UntestLoadMapInstance(World, MapPackageName, LevelName);
+	if (StreamingLevel == nullptr)
 	{
-		World->BeginTearingDown();
+		TestContext.AddError(FString::Printf(TEXT("Failed to load map %s into %s"), *MapPackageName, *World->GetName()));
+		co_return false;
+	}
+	FUntestClientServerPool::Get().AddPIEPackageName(StreamingLevel->GetWorldAssetPackageFName());
 
-		// DestroyWorld doesn't do this and instead waits for GC to clear everything up
-		for (auto It = TActorIterator<AActor>(World); It; ++It)
-		{
-			It->Destroy();
-		}
+	const bool bVisible = co_await UntestWaitForMapInstance(World, StreamingLevel);
+	if (bVisible == false)
+	{
+		TestContext.AddError(FString::Printf(TEXT("Map %s didn't finish loading into %s"), *MapPackageName, *World->GetName()));
+	}
+	co_return bVisible;
+}
+
+FBVClientServerTestFixture::~FBVClientServerTestFixture()
+{
+	// If the test timeouts, it won't get a chance to run the normal teardown logic, so we attempt
+	// to run it again here just in case.
+	TeardownClientServer();
+}
+
+// See UEditorEngine::CreateInnerProcessPIEGameInstance() for the reference code for this setup logic
+UWorld* FBVClientServerTestFixture::CreateNetWorld(const FString& TestName, const EUntestWorldType::Enum WorldType, const FUntestGameClasses& Classes)
+{
+	FUntestContext& TestContext = GetContext();
+
+	FString PackageCommonName = FString::Printf(TEXT("TestPackage_%s"), *TestName);
+	PackageCommonName.ReplaceCharInline('.', '_'); // UE seems to replace the final . with a : so just use underscores for consistency
+
+	// UE expects that replicated worlds are owned by a parent package, since they need to have a stable name for networking. However
+	// the world creation process will spawn actors into the parent package that have fixed names, which isn't allowed as all uobjects
+	// must have unique names. PIE cheats by having the names of the packages be distinct, but remapping them when doing replication
+	// so that the names match up, so we will hook into that system here. See UEditorEngine::NetworkRemapPath() and its usage in
+	// PackageMapClient.cpp
+	const FString PIEPackagePrefix = UWorld::BuildPIEPackagePrefix(WorldType);
+	const FString PackageName = FString::Printf(TEXT("/Untest/%s%s"), *PIEPackagePrefix, *PackageCommonName);
+	FUntestClientServerPool::Get().AddPIEPackageName(FName(*PackageName));
+
+	// Add PKG_NewlyCreated flag to this package so we don't try to resolve its linker as it is unsaved duplicated world package
+	UPackage* Package = NewObject<UPackage>(nullptr, *PackageName);
+	Package->SetPackageFlags(PKG_NewlyCreated);
+	Package->AddToRoot();
+	Package->MarkAsFullyLoaded();
+
+	TestContext.Packages[WorldType] = Package;
+
+	UUntestGameInstance* GameInstance = CastChecked<UUntestGameInstance>(NewObject<UUntestGameInstance>(Package, Classes.GameInstanceClass));
+	TestContext.GameInstances[WorldType] = GameInstance;
+
+	GameInstance->Init();
+	GameInstance->ClearFlags(RF_Standalone);
+	GameInstance->AddToRoot();
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	GameInstance->SetWorldContext(&WorldContext);
+	WorldContext.PIEInstance = WorldType;
+	WorldContext.bWaitingOnOnlineSubsystem = false;
+
+	if (GEditor)
+	{
+		WorldContext.PIEWorldFeatureLevel = GEditor->PreviewPlatform.GetEffectivePreviewFeatureLevel();
+	}
+	WorldContext.RunAsDedicated = (WorldType == EUntestWorldType::Server);
+	WorldContext.bIsPrimaryPIEInstance = false;
+	WorldContext.OwningGameInstance = GameInstance;
+
+	const bool bInformEngineOfWorld = false;
+	const FName WorldName = FName(*FString::Printf(TEXT("TestWorld_%s"), *TestName));
+	const bool bAddToRoot = false;
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, bInformEngineOfWorld, WorldName, Package, bAddToRoot, ERHIFeatureLevel::Num, nullptr, true /*bSkipInitWorld*/);
+	if (World == nullptr)
+	{
+		TestContext.AddError(FString::Printf(TEXT("Failed to create %s world"), (WorldType == EUntestWorldType::Server) ? TEXT("server") : TEXT("client")));
+		return nullptr;
+	}
+
+	World->GetWorldSettings()->DefaultGameMode = Classes.GameModeClass;
+	World->SetGameInstance(GameInstance);
+	World->ClearFlags(RF_Standalone);
+	World->SetPlayInEditorInitialNetMode((WorldType == EUntestWorldType::Server) ? NM_DedicatedServer : NM_Client);
+	World->bAllowAudioPlayback = false;
+	World->bIsNameStableForNetworking = true;
+	World->StreamingLevelsPrefix = PIEPackagePrefix;
+	WorldContext.SetCurrentWorld(World);
+
+	TestContext.Worlds[WorldType] = World;
+	return World;
+}
+
+// Opens the server world's port and begins play. The world must have been initialized for play with URL.
+bool FBVClientServerTestFixture::ListenNetWorld(UWorld* World, FURL& URL, const FUntestGameClasses& Classes, uint16& OutPort)
+{
+	FUntestContext& TestContext = GetContext();
+
+	// See UGameInstance::EnableListenServer() for this logic. We can't call it directly because it requires
+	// the World to be PIE.
+	URL.AddOption(TEXT("Listen"));
+	check(World->GetNetDriver() == nullptr);
 
-		GEngine->DestroyWorldContext(World);
-		World->RemoveFromRoot();
-		World->DestroyWorld(false /*bInformEngineOfWorld*/);
+	// Same as UWorld::Listen(), except the NetDriver comes from the fixture's game classes instead of the project's
+	// GameNetDriver definition
+	const FName NetDriverDefinition = UUntestLoopbackNetDriver::RegisterDefinition(Classes.NetDriverClass);
+	if (GEngine->CreateNamedNetDriver(World, NAME_GameNetDriver, NetDriverDefinition) == false)
+	{
+		TestContext.AddError(FString::Printf(TEXT("Failed to create %s"), *Classes.NetDriverClass->GetName()));
+		return false;
 	}
 
-	if (UGameInstance* GameInstance = TestContext.GameInstances[EUntestWorldType::Server].Get())
+	UNetDriver* NetDriver = GEngine->FindNamedNetDriver(World, NAME_GameNetDriver);
+	World->SetNetDriver(NetDriver);
+	NetDriver->SetWorld(World);
+	if (FLevelCollection* SourceCollection = World->FindCollectionByType(ELevelCollectionType::DynamicSourceLevels))
+	{
+		SourceCollection->SetNetDriver(NetDriver);
+	}
+	if (FLevelCollection* StaticCollection = World->FindCollectionByType(ELevelCollectionType::StaticLevels))
 	{
-		GameInstance->Shutdown();
-		GameInstance->RemoveFromRoot();
-		GameInstance->ConditionalBeginDestroy();
+		StaticCollection->SetNetDriver(NetDriver);
 	}
 
-	if (UPackage* Package = TestContext.Packages[EUntestWorldType::Server].Get())
+	// This actually opens the port
+	FString ListenError;
+	if (NetDriver->InitListen(World, URL, false /*bReuseAddressAndPort*/, ListenError) == false)
 	{
-		Package->RemoveFromRoot();
-		Package->ConditionalBeginDestroy();
+		TestContext.AddError(FString::Printf(TEXT("Failed to start listen server: %s"), *ListenError));
+		GEngine->DestroyNamedNetDriver(World, NAME_GameNetDriver);
+		World->SetNetDriver(nullptr);
+		return false;
 	}
+	check(World->GetNetMode() == NM_DedicatedServer);
 
-	TestContext.Worlds[EUntestWorldType::Server].Reset();
-	TestContext.GameInstances[EUntestWorldType::Server].Reset();
-	TestContext.Packages[EUntestWorldType::Server].Reset();
+	// Swapped in before any client connects, so the new driver sees every connection from the start. Iris replaces
+	// replication drivers entirely, so there's nothing to swap when it's on.
+	if (Classes.ReplicationDriverClass && NetDriver->IsUsingIrisReplication() == false)
+	{
+		NetDriver->SetReplicationDriver(NewObject<UReplicationDriver>(GetTransientPackage(), Classes.ReplicationDriverClass));
+	}
+	if (UReplicationGraph* Graph = Cast<UReplicationGraph>(NetDriver->GetReplicationDriver()))
+	{
+		UUntestReplicationGraphProbe::Install(Graph);
+	}
+
+	TSharedPtr<const FInternetAddr> ListenAddr = NetDriver->GetLocalAddr();
+	OutPort = ListenAddr.IsValid() ? static_cast<uint16>(ListenAddr->GetPort()) : 0;
+	if (OutPort == 0)
+	{
+		TestContext.AddError(TEXT("Listen server didn't report the port it's bound to"));
+		return false;
+	}
+	URL.Port = OutPort;
+
+	World->BeginPlay();
+	NetDriver->bNoTimeouts = true;
+	return true;
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// FBVClientServerTestFixture
+// Starts connecting a client world to the server at URL. The caller ticks the returned pending game until it has
+// connected, then calls FinishConnectNetWorld(). Returns null with OutError set if the connection couldn't be started.
+UPendingNetGame* FBVClientServerTestFixture::BeginConnectNetWorld(UWorld* World, const FURL& URL, const FUntestGameClasses& Classes, FString& OutError)
+{
+	FWorldContext& WorldContext = GEngine->GetWorldContextFromWorldChecked(World);
 
-FBVClientServerTestFixture::~FBVClientServerTestFixture()
+	// If any of our game instances need this then we'll need to rework the below code
+	check(WorldContext.OwningGameInstance->DelayPendingNetGameTravel() == false);
+
+	UPendingNetGame* PendingNetGame = NewObject<UPendingNetGame>();
+	WorldContext.PendingNetGame = PendingNetGame; // need to set this because InitNetDriver looks at it
+	PendingNetGame->Initialize(URL);
+
+	// Same as UPendingNetGame::InitNetDriver(), with the fixture's NetDriver
+	const FName NetDriverDefinition = UUntestLoopbackNetDriver::RegisterDefinition(Classes.NetDriverClass);
+	if (GEngine->CreateNamedNetDriver(PendingNetGame, NAME_PendingNetDriver, NetDriverDefinition))
+	{
+		PendingNetGame->NetDriver = GEngine->FindNamedNetDriver(PendingNetGame, NAME_PendingNetDriver);
+	}
+	if (PendingNetGame->NetDriver == nullptr || PendingNetGame->NetDriver->InitConnect(PendingNetGame, URL, OutError) == false)
+	{
+		return nullptr;
+	}
+	PendingNetGame->NetDriver->bNoTimeouts = true;
+
+	UNetConnection* ServerConnection = PendingNetGame->NetDriver->ServerConnection;
+	if (ServerConnection->Handler.IsValid())
+	{
+		ServerConnection->Handler->BeginHandshaking(FPacketHandlerHandshakeComplete::CreateUObject(PendingNetGame, &UPendingNetGame::SendInitialJoin));
+	}
+	else
+	{
+		PendingNetGame->SendInitialJoin();
+	}
+
+	return PendingNetGame;
+}
+
+// Hands the connected pending game's NetDriver to the client world and initializes the world. It still has to be
+// initialized for play.
+void FBVClientServerTestFixture::FinishConnectNetWorld(UWorld* World, UPendingNetGame* PendingNetGame)
 {
-	// If the test timeouts, it won't get a chance to run the normal teardown logic, so we attempt
-	// to run it again here just in case.
-	TeardownClientServer();
+	FWorldContext& WorldContext = GEngine->GetWorldContextFromWorldChecked(World);
+
+	PendingNetGame->NetDriver->NetDriverName = NAME_GameNetDriver;
+	World->SetNetDriver(PendingNetGame->NetDriver);
+	PendingNetGame->NetDriver->SetWorld(World);
+
+	PendingNetGame->SendJoin();
+	PendingNetGame->NetDriver = nullptr;
+	PendingNetGame->ConditionalBeginDestroy();
+	WorldContext.PendingNetGame = nullptr;
+
+	World->FlushLevelStreaming(EFlushLevelStreamingType::Visibility);
+	World->InitWorld(UWorld::InitializationValues());
+
+	// These level collections are created in InitWorld, and their NetDriver will eventually override the one in
+	// the UWorld, so we set it up as soon as possible
+	if (FLevelCollection* SourceCollection = World->FindCollectionByType(ELevelCollectionType::DynamicSourceLevels))
+	{
+		SourceCollection->SetNetDriver(World->GetNetDriver());
+	}
+	if (FLevelCollection* StaticCollection = World->FindCollectionByType(ELevelCollectionType::StaticLevels))
+	{
+		StaticCollection->SetNetDriver(World->GetNetDriver());
+	}
 }
 
 UntestTask FBVClientServerTestFixture::SetupFixture(const FString TestName)
@@ -242,77 +602,65 @@ UntestTask FBVClientServerTestFixture::SetupFixture(const FString TestName)
 	const FUntestGameClasses Classes = {
 		DefaultClasses.GameInstanceClass ? DefaultClasses.GameInstanceClass : TSubclassOf<UUntestGameInstance>(UUntestGameInstance::StaticClass()),
 		DefaultClasses.GameModeClass ? DefaultClasses.GameModeClass : TSubclassOf<AGameModeBase>(AGameModeBase::StaticClass()),
+		DefaultClasses.NetDriverClass ? DefaultClasses.NetDriverClass : TSubclassOf<UNetDriver>(UUntestLoopbackNetDriver::StaticClass()),
+		DefaultClasses.ReplicationDriverClass,
 	};
-
 	FUntestContext& TestContext = GetContext();
 
-	FString PackageCommonName = FString::Printf(TEXT("TestPackage_%s"), *TestName);
-	PackageCommonName.ReplaceCharInline('.', '_'); // UE seems to replace the final . with a : so just use underscores for consistency
-
-	// See UEditorEngine::CreateInnerProcessPIEGameInstance() for the reference code for this setup logic
-	for (int32 TestWorldType = EUntestWorldType::Server; TestWorldType != EUntestWorldType::Count; ++TestWorldType)
-	{
-		const ENetMode NetMode = (TestWorldType == EUntestWorldType::Server) ? NM_DedicatedServer : NM_Client;
-		const TCHAR* NetModeStr = (TestWorldType == EUntestWorldType::Server) ? TEXT("Server") : TEXT("Client");
-
-		// UE expects that replicated worlds are owned by a parent package, since they need to have a stable name for networking. However
-		// the world creation process will spawn actors into the parent package that have fixed names, which isn't allowed as all uobjects
-		// must have unique names. PIE cheats by having the names of the packages be distinct, but remapping them when doing replication
-		// so that the names match up, so we will hook into that system here. See UEditorEngine::NetworkRemapPath() and its usage in
-		// PackageMapClient.cpp
-		const FString PIEPackagePrefix = UWorld::BuildPIEPackagePrefix(TestWorldType);
-		const FString PackageName = FString::Printf(TEXT("/Untest/%s%s"), *PIEPackagePrefix, *PackageCommonName);
-		FSoftObjectPath::AddPIEPackageName(FName(*PackageName));
+	const int32 NumClients = FMath::Max(GetNumClients(), 1);
+	const int32 NumWorlds = EUntestWorldType::Client + NumClients;
+	TestContext.SetNumWorlds(NumWorlds);
 
-		// Add PKG_NewlyCreated flag to this package so we don't try to resolve its linker as it is unsaved duplicated world package
-		UPackage* Package = NewObject<UPackage>(nullptr, *PackageName);
-		Package->SetPackageFlags(PKG_NewlyCreated);
-		Package->AddToRoot();
-		Package->MarkAsFullyLoaded();
+	const FString ReplicationDriverName = Classes.ReplicationDriverClass ? Classes.ReplicationDriverClass->GetPathName() : FString();
+	const FString MapPackageName = TestContext.GetMapPackageName();
+	const FString PoolKey = FString::Printf(TEXT("%s|%s|%s|%s|%d|%s"), *Classes.GameInstanceClass->GetPathName(), *Classes.GameModeClass->GetPathName(), *Classes.NetDriverClass->GetPathName(), *ReplicationDriverName, NumClients, *MapPackageName);
 
-		TestContext.Packages[TestWorldType] = Package;
+	FUntestPooledClientServer PooledPair;
+	const bool bCanAcquirePooledPair = CanReuseClientServer() && GetReplayRecordingName().IsEmpty();
+	if (bCanAcquirePooledPair && FUntestClientServerPool::Get().TryAcquire(PoolKey, TestName, PooledPair))
+	{
+		TestContext.Packages = PooledPair.Packages;
+		TestContext.GameInstances = PooledPair.GameInstances;
+		TestContext.Worlds = PooledPair.Worlds;
+		TestContext.SetNetProfile(GetNetProfile());
 
-		UUntestGameInstance* GameInstance = CastChecked<UUntestGameInstance>(NewObject<UUntestGameInstance>(Package, Classes.GameInstanceClass));
-		TestContext.GameInstances[TestWorldType] = GameInstance;
+		co_await Setup(TestContext);
+		co_return;
+	}
 
-		GameInstance->Init();
-		GameInstance->ClearFlags(RF_Standalone);
-		GameInstance->AddToRoot();
+	PooledPair.Key = PoolKey;
+	PooledPair.LastTestName = TestName;
 
-		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
-		GameInstance->SetWorldContext(&WorldContext);
-		WorldContext.PIEInstance = TestWorldType;
-		WorldContext.bWaitingOnOnlineSubsystem = false;
+	// Waits for the map's content without blocking, so each world below only has to instance it
+	if (MapPackageName.IsEmpty() == false)
+	{
+		const bool bMapLoaded = co_await FUntestMapPreloader::Get().WaitUntilLoaded(MapPackageName, TestContext);
+		if (bMapLoaded == false)
+		{
+			co_return;
+		}
+	}
+	FString MapLevelName = FString::Printf(TEXT("UntestMap_%s"), *TestName);
+	MapLevelName.ReplaceCharInline('.', '_');
 
-		WorldContext.PIEWorldFeatureLevel = GEditor->PreviewPlatform.GetEffectivePreviewFeatureLevel();
-		WorldContext.RunAsDedicated = (TestWorldType == EUntestWorldType::Server);
-		WorldContext.bIsPrimaryPIEInstance = false;
-		WorldContext.OwningGameInstance = GameInstance;
+	// The server listens on a port picked by its NetDriver (the OS for socket drivers) rather than the fixed PIE port, so
+	// several ClientServer tests can run at once without fighting over it. The client connects to whatever port the
+	// server ended up with.
+	uint16 ServerPort = 0;
 
-		const bool bInformEngineOfWorld = false;
-		const FName WorldName = FName(*FString::Printf(TEXT("TestWorld_%s"), *TestName));
-		const bool bAddToRoot = false;
+	for (int32 TestWorldType = EUntestWorldType::Server; TestWorldType < NumWorlds; ++TestWorldType)
+	{
+		const EUntestWorldType::Enum WorldType = static_cast<EUntestWorldType::Enum>(TestWorldType);
+		const ENetMode NetMode = (WorldType == EUntestWorldType::Server) ? NM_DedicatedServer : NM_Client;
+		const TCHAR* NetModeStr = (WorldType == EUntestWorldType::Server) ? TEXT("Server") : TEXT("Client");
 
-		UWorld* World = UWorld::CreateWorld(EWorldType::Game, bInformEngineOfWorld, WorldName, Package, bAddToRoot, ERHIFeatureLevel::Num, nullptr, true /*bSkipInitWorld*/);
+		UWorld* World = CreateNetWorld(TestName, WorldType, Classes);
 		if (World == nullptr)
 		{
-			TestContext.AddError(TEXT("Failed to create test world for netmode"));
 			co_return;
 		}
+		FWorldContext& WorldContext = GEngine->GetWorldContextFromWorldChecked(World);
 
-		World->GetWorldSettings()->DefaultGameMode = Classes.GameModeClass;
-		World->SetGameInstance(GameInstance);
-		World->ClearFlags(RF_Standalone);
-		World->SetPlayInEditorInitialNetMode(NetMode);
-		World->bAllowAudioPlayback = false;
-		World->bIsNameStableForNetworking = true;
-		WorldContext.SetCurrentWorld(World);
-
-		TestContext.Worlds[TestWorldType] = World;
-
-		const ULevelEditorPlaySettings* DefaultSettings = GetDefault<ULevelEditorPlaySettings>();
-		uint16 ServerPort = 0;
-		DefaultSettings->GetServerPort(ServerPort);
 		const FString URLString = FString::Printf(TEXT("127.0.0.1:%hu"), ServerPort);
 		FURL URL = FURL(nullptr, *URLString, TRAVEL_Absolute);
 		// URL.Map = TEXT("/Game/Developers/Test/Levels/Default");
@@ -322,6 +670,15 @@ UntestTask FBVClientServerTestFixture::SetupFixture(const FString TestName)
 		{
 			World->InitWorld(UWorld::InitializationValues());
 
+			if (MapPackageName.IsEmpty() == false)
+			{
+				const bool bMapLoaded = co_await LoadClientServerMap(TestContext, World, MapLevelName);
+				if (bMapLoaded == false)
+				{
+					co_return;
+				}
+			}
+
 			// Finish server world loading and open net connection
 			check(World->GetAuthGameMode() == nullptr);
 
@@ -353,34 +710,23 @@ UntestTask FBVClientServerTestFixture::SetupFixture(const FString TestName)
 			// TODO should we do this?
 			// GEngine->BlockTillLevelStreamingCompleted(World);
 
-			// See UGameInstance::EnableListenServer() for this logic. We can't call it directly because it requires
-			// the World to be PIE.
-			URL.AddOption(TEXT("Listen"));
-			check(World->GetNetDriver() == nullptr);
-
-			// This actually opens the port
-			if (World->Listen(URL) == false)
+			if (ListenNetWorld(World, URL, Classes, ServerPort) == false)
 			{
-				TestContext.AddError(TEXT("Failed to start listen server"));
 				co_return;
 			}
-			check(World->GetNetMode() == NM_DedicatedServer);
-
-			World->BeginPlay();
-			World->GetNetDriver()->bNoTimeouts = true;
 		}
 		else
 		{
-			// If any of our game instances need this then we'll need to rework the below code
-			check(WorldContext.OwningGameInstance->DelayPendingNetGameTravel() == false);
-
 			// Connect client world to server
-			UPendingNetGame* PendingNetGame = NewObject<UPendingNetGame>();
-			WorldContext.PendingNetGame = PendingNetGame; // need to set this because InitNetDriver looks at it
-			PendingNetGame->Initialize(URL);
-			PendingNetGame->InitNetDriver();
-			PendingNetGame->NetDriver->bNoTimeouts = true;
+			FString ConnectError;
+			UPendingNetGame* PendingNetGame = BeginConnectNetWorld(World, URL, Classes, ConnectError);
+			if (PendingNetGame == nullptr)
+			{
+				TestContext.AddError(FString::Printf(TEXT("Failed to connect %s to server: %s"), NetModeStr, *ConnectError));
+				co_return;
+			}
 
+			constexpr int32 MaxConnectRoundsPerTick = 8;
 			double LastTimestamp = FPlatformTime::Seconds();
 
 			auto TryConnectFunc = [&TestContext, PendingNetGame, &LastTimestamp]()
@@ -393,33 +739,32 @@ UntestTask FBVClientServerTestFixture::SetupFixture(const FString TestName)
 				ServerWorld->Tick(LEVELTICK_All, DeltaSeconds); // give server NetDriver a chance to respond to requests
 				PendingNetGame->Tick(DeltaSeconds);
 
+				// Each login message is only answered when the other side's NetDriver next ticks. In-memory connections
+				// deliver instantly, so run extra dispatch/flush rounds on both ends and finish the handshake this frame.
+				UNetDriver* ServerNetDriver = ServerWorld->GetNetDriver();
+				for (int32 Round = 0; Round < MaxConnectRoundsPerTick && !PendingNetGame->bSuccessfullyConnected; ++Round)
+				{
+					ServerNetDriver->TickDispatch(0.0f);
+					ServerNetDriver->PostTickDispatch();
+					ServerNetDriver->TickFlush(0.0f);
+					ServerNetDriver->PostTickFlush();
+					PendingNetGame->Tick(0.0f);
+				}
+
 				check(PendingNetGame->bSentJoinRequest == false);
 				return PendingNetGame->bSuccessfullyConnected;
 			};
 			co_await Squid::WaitUntil(TryConnectFunc);
 
-			PendingNetGame->NetDriver->NetDriverName = NAME_GameNetDriver;
-			World->SetNetDriver(PendingNetGame->NetDriver);
-			PendingNetGame->NetDriver->SetWorld(World);
+			FinishConnectNetWorld(World, PendingNetGame);
 
-			PendingNetGame->SendJoin();
-			PendingNetGame->NetDriver = NULL;
-			PendingNetGame->ConditionalBeginDestroy();
-			PendingNetGame = nullptr;
-			WorldContext.PendingNetGame = nullptr;
-
-			World->FlushLevelStreaming(EFlushLevelStreamingType::Visibility);
-			World->InitWorld(UWorld::InitializationValues());
-
-			// These level collections are created in InitWorld, and their NetDriver will eventually override the one in
-			// the UWorld, so we set it up as soon as possible
-			if (FLevelCollection* SourceCollection = World->FindCollectionByType(ELevelCollectionType::DynamicSourceLevels))
-			{
-				SourceCollection->SetNetDriver(World->GetNetDriver());
-			}
-			if (FLevelCollection* StaticCollection = World->FindCollectionByType(ELevelCollectionType::StaticLevels))
+			if (MapPackageName.IsEmpty() == false)
 			{
-				StaticCollection->SetNetDriver(World->GetNetDriver());
+				const bool bMapLoaded = co_await LoadClientServerMap(TestContext, World, MapLevelName);
+				if (bMapLoaded == false)
+				{
+					co_return;
+				}
 			}
 
 			World->InitializeActorsForPlay(URL, true /*bResetTime*/, nullptr /*FRegisterComponentContext*/);
@@ -429,7 +774,7 @@ UntestTask FBVClientServerTestFixture::SetupFixture(const FString TestName)
 				const FPlatformUserId UserId = IPlatformInputDeviceMapper::Get().GetPrimaryPlatformUser();
 
 				ULocalPlayer* NewPlayer = NewObject<ULocalPlayer>(GEngine, ULocalPlayer::StaticClass());
-				int32 InsertIndex = GameInstance->AddLocalPlayer(NewPlayer, UserId);
+				int32 InsertIndex = World->GetGameInstance()->AddLocalPlayer(NewPlayer, UserId);
 				check(InsertIndex != INDEX_NONE);
 			}
 		}
@@ -437,38 +782,391 @@ UntestTask FBVClientServerTestFixture::SetupFixture(const FString TestName)
 		WorldContext.LastURL = URL;
 	}
 
+	// Wait for the server to finish logging the clients in, so the player controllers, player states and pawns exist
+	// before the test starts and are part of the baseline that's kept when the pair is reset for the next test
+	double LastTimestamp = FPlatformTime::Seconds();
+
+	auto HaveJoinedFunc = [&TestContext, &LastTimestamp, NumClients]()
+	{
+		const double Now = FPlatformTime::Seconds();
+		const double DeltaSeconds = Now - LastTimestamp;
+		LastTimestamp = Now;
+
+		bool bClientsHavePlayers = true;
+		for (const TWeakObjectPtr<UWorld>& World : TestContext.Worlds)
+		{
+			World->Tick(LEVELTICK_All, DeltaSeconds);
+			if (World->GetNetMode() == NM_Client)
+			{
+				bClientsHavePlayers &= (World->GetFirstPlayerController() != nullptr);
+			}
+		}
+
+		const UNetDriver* ServerNetDriver = TestContext.Worlds[EUntestWorldType::Server]->GetNetDriver();
+		if (ServerNetDriver == nullptr || ServerNetDriver->ClientConnections.Num() < NumClients)
+		{
+			return false;
+		}
+
+		for (const UNetConnection* Connection : ServerNetDriver->ClientConnections)
+		{
+			if (Connection->PlayerController == nullptr)
+			{
+				return false;
+			}
+		}
+
+		return bClientsHavePlayers;
+	};
+	co_await Squid::WaitUntil(HaveJoinedFunc);
+
+	// Clients tell the server when a level becomes visible through their player controller, which didn't exist yet when
+	// the map was loaded. The server doesn't replicate a level's actors to a client until it has heard about the level.
+	if (MapPackageName.IsEmpty() == false)
+	{
+		for (int32 TestWorldType = EUntestWorldType::Client; TestWorldType < NumWorlds; ++TestWorldType)
+		{
+			UWorld* World = TestContext.Worlds[TestWorldType].Get();
+			APlayerController* PlayerController = World->GetFirstPlayerController();
+			for (ULevelStreaming* StreamingLevel : World->GetStreamingLevels())
+			{
+				if (StreamingLevel && StreamingLevel->IsLevelVisible())
+				{
+					PlayerController->ServerUpdateLevelVisibility(FUpdateLevelVisibilityLevelInfo(StreamingLevel->GetLoadedLevel(), true));
+				}
+			}
+		}
+
+		auto HaveLevelsFunc = [&TestContext, &LastTimestamp]()
+		{
+			const double Now = FPlatformTime::Seconds();
+			const double DeltaSeconds = Now - LastTimestamp;
+			LastTimestamp = Now;
+
+			for (const TWeakObjectPtr<UWorld>& World : TestContext.Worlds)
+			{
+				World->Tick(LEVELTICK_All, DeltaSeconds);
+			}
+
+			UWorld* ServerWorld = TestContext.Worlds[EUntestWorldType::Server].Get();
+			for (const UNetConnection* Connection : ServerWorld->GetNetDriver()->ClientConnections)
+			{
+				for (const ULevelStreaming* StreamingLevel : ServerWorld->GetStreamingLevels())
+				{
+					if (StreamingLevel && StreamingLevel->GetLoadedLevel() && Connection->ClientHasInitializedLevel(StreamingLevel->GetLoadedLevel()) == false)
+					{
+						return false;
+					}
+				}
+			}
+			return true;
+		};
+		co_await Squid::WaitUntil(HaveLevelsFunc);
+	}
+
+	PooledPair.Packages = TestContext.Packages;
+	PooledPair.GameInstances = TestContext.GameInstances;
+	PooledPair.Worlds = TestContext.Worlds;
+	FUntestClientServerPool::Get().Add(MoveTemp(PooledPair));
+
+	// Simulated conditions only start once everyone is connected, so they don't slow down the login above
+	TestContext.SetNetProfile(GetNetProfile());
+
 	co_await Setup(TestContext);
 }
 
+// Running totals from a test's NetDrivers. Pooled drivers keep counting across tests, so the fixture's net stats are the
+// difference between samples taken while the test runs and one taken when it started.
+struct FUntestNetTotals
+{
+	uint64 OutBytes = 0;
+	uint64 InBytes = 0;
+	uint64 OutPackets = 0;
+	uint64 InPackets = 0;
+	uint64 OutBunches = 0;
+	uint64 InBunches = 0;
+	uint64 OutRPCs = 0;
+	uint64 InRPCs = 0;
+	uint64 ReplicatedActors = 0;
+	double ReplicateActorsSeconds = 0.0;
+};
+
+static FUntestNetTotals SampleNetTotals(TArrayView<const TWeakObjectPtr<UWorld>> Worlds)
+{
+	FUntestNetTotals Totals;
+	for (int32 TestWorldType = EUntestWorldType::Server; TestWorldType < Worlds.Num(); ++TestWorldType)
+	{
+		const UWorld* World = Worlds[TestWorldType].Get();
+		const UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+		if (NetDriver == nullptr)
+		{
+			continue;
+		}
+
+		const UUntestLoopbackNetDriver* LoopbackNetDriver = Cast<UUntestLoopbackNetDriver>(NetDriver);
+		if (TestWorldType == EUntestWorldType::Server)
+		{
+			Totals.OutBytes = NetDriver->OutTotalBytes;
+			Totals.InBytes = NetDriver->InTotalBytes;
+			Totals.OutPackets = NetDriver->OutTotalPackets;
+			Totals.InPackets = NetDriver->InTotalPackets;
+			Totals.OutBunches = NetDriver->OutTotalBunches;
+			Totals.InBunches = NetDriver->InTotalBunches;
+			if (LoopbackNetDriver)
+			{
+				Totals.OutRPCs = LoopbackNetDriver->GetCounters().RemoteFunctions;
+				Totals.ReplicatedActors = LoopbackNetDriver->GetCounters().ReplicatedActors;
+				Totals.ReplicateActorsSeconds = LoopbackNetDriver->GetCounters().ReplicateActorsSeconds;
+			}
+		}
+		else if (LoopbackNetDriver)
+		{
+			Totals.InRPCs += LoopbackNetDriver->GetCounters().RemoteFunctions;
+		}
+	}
+	return Totals;
+}
+
+static void UpdateNetStats(FUntestNetStats& Stats, const FUntestNetTotals& Start, const FUntestNetTotals& Previous, const FUntestNetTotals& Current, double DurationSeconds)
+{
+	++Stats.Frames;
+	Stats.DurationSeconds = DurationSeconds;
+	Stats.OutBytes = Current.OutBytes - Start.OutBytes;
+	Stats.InBytes = Current.InBytes - Start.InBytes;
+	Stats.OutPackets = Current.OutPackets - Start.OutPackets;
+	Stats.InPackets = Current.InPackets - Start.InPackets;
+	Stats.OutBunches = Current.OutBunches - Start.OutBunches;
+	Stats.InBunches = Current.InBunches - Start.InBunches;
+	Stats.OutRPCs = Current.OutRPCs - Start.OutRPCs;
+	Stats.InRPCs = Current.InRPCs - Start.InRPCs;
+	Stats.ReplicatedActors = Current.ReplicatedActors - Start.ReplicatedActors;
+	Stats.ReplicateActorsMs = (Current.ReplicateActorsSeconds - Start.ReplicateActorsSeconds) * 1000.0;
+
+	const int32 FrameReplicatedActors = static_cast<int32>(Current.ReplicatedActors - Previous.ReplicatedActors);
+	const double FrameReplicateActorsMs = (Current.ReplicateActorsSeconds - Previous.ReplicateActorsSeconds) * 1000.0;
+	Stats.MaxReplicatedActorsPerFrame = FMath::Max(Stats.MaxReplicatedActorsPerFrame, FrameReplicatedActors);
+	Stats.MaxReplicateActorsMsPerFrame = FMath::Max(Stats.MaxReplicateActorsMsPerFrame, FrameReplicateActorsMs);
+}
+
+static void SampleRoundTripTimes(FUntestNetStats& Stats, TArrayView<const TWeakObjectPtr<UWorld>> Worlds)
+{
+	// AvgLag is the connection's average time from sending a packet to having it acked, refreshed once per stat
+	// period. Until the first period ends it holds a large placeholder, which isn't a measurement.
+	constexpr float MaxMeasuredLagSeconds = 60.0f;
+
+	for (int32 TestWorldType = EUntestWorldType::Client; TestWorldType < Worlds.Num(); ++TestWorldType)
+	{
+		const UWorld* World = Worlds[TestWorldType].Get();
+		const UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+		const UNetConnection* Connection = NetDriver ? NetDriver->ServerConnection.Get() : nullptr;
+		if (Connection == nullptr || Connection->AvgLag <= 0.0f || Connection->AvgLag >= MaxMeasuredLagSeconds)
+		{
+			continue;
+		}
+
+		const double RttMs = Connection->AvgLag * 1000.0;
+		++Stats.RttSamples;
+		Stats.AvgRttMs += (RttMs - Stats.AvgRttMs) / Stats.RttSamples;
+		Stats.MaxRttMs = FMath::Max(Stats.MaxRttMs, RttMs);
+	}
+}
+
+static void RecordReplicationGraphMetrics(FUntestContext& TestContext, const UUntestReplicationGraphProbe* Probe)
+{
+	const UWorld* ServerWorld = TestContext.Worlds[EUntestWorldType::Server].Get();
+	const UNetDriver* NetDriver = ServerWorld ? ServerWorld->GetNetDriver() : nullptr;
+	if (Probe == nullptr || NetDriver == nullptr)
+	{
+		return;
+	}
+
+	// Connections are numbered in the order they were accepted, which is the order the clients connected in
+	double TotalGatherMs = 0.0;
+	double TotalPrioritizeMs = 0.0;
+	int32 NumMeasured = 0;
+	for (int32 Index = 0; Index < NetDriver->ClientConnections.Num(); ++Index)
+	{
+		const FUntestConnectionReplicationTimings* Timings = Probe->GetTimings(NetDriver->ClientConnections[Index]);
+		if (Timings == nullptr || Timings->Frames == 0)
+		{
+			continue;
+		}
+
+		const double GatherMs = Timings->GatherSeconds * 1000.0 / Timings->Frames;
+		const double PrioritizeMs = Timings->PrioritizeSeconds * 1000.0 / Timings->Frames;
+		TestContext.AddMetric(FString::Printf(TEXT("RepGraph.Connection%d.GatherMs"), Index), GatherMs);
+		TestContext.AddMetric(FString::Printf(TEXT("RepGraph.Connection%d.PrioritizeMs"), Index), PrioritizeMs);
+		TotalGatherMs += GatherMs;
+		TotalPrioritizeMs += PrioritizeMs;
+		++NumMeasured;
+	}
+
+	if (NumMeasured > 0)
+	{
+		TestContext.AddMetric(TEXT("RepGraph.GatherMs.Avg"), TotalGatherMs / NumMeasured);
+		TestContext.AddMetric(TEXT("RepGraph.PrioritizeMs.Avg"), TotalPrioritizeMs / NumMeasured);
+	}
+}
+
 UntestTask FBVClientServerTestFixture::RunFixture(const FString TestName)
 {
 	BV_FIXTURE_TASK_NAME(TestName);
 
-	UntestTask ServerTask = Run(GetContext(), EUntestWorldType::Server);
-	UntestTask ClientTask = Run(GetContext(), EUntestWorldType::Client);
+	FUntestContext& TestContext = GetContext();
+	const int32 NumClients = TestContext.GetNumClients();
 
-	double LastTimestamp = FPlatformTime::Seconds();
+	// One task per world, indexed by EUntestWorldType
+	TArray<UntestTask> Tasks;
+	Tasks.Reserve(TestContext.Worlds.Num());
+	for (int32 TestWorldType = EUntestWorldType::Server; TestWorldType < TestContext.Worlds.Num(); ++TestWorldType)
+	{
+		Tasks.Emplace(Run(TestContext, static_cast<EUntestWorldType::Enum>(TestWorldType)));
+	}
+
+	const double RunBegin = FPlatformTime::Seconds();
+	double LastTimestamp = RunBegin;
+
+	int32 NumServerTicks = 0;
+	double TotalServerTickMs = 0.0;
+	double MaxServerTickMs = 0.0;
+
+	TestContext.NetStats = FUntestNetStats();
+
+	// Pooled servers keep their probe between tests, so only this test's frames are counted
+	UWorld* ServerWorld = TestContext.Worlds[EUntestWorldType::Server].Get();
+	TWeakObjectPtr<UUntestReplicationGraphProbe> ReplicationGraphProbe = UUntestReplicationGraphProbe::Find(ServerWorld ? ServerWorld->GetNetDriver() : nullptr);
+	if (ReplicationGraphProbe.IsValid())
+	{
+		ReplicationGraphProbe->ResetTimings();
+	}
 
-	auto Func = [this, &ServerTask, &ClientTask, &LastTimestamp]()
+	const FString ReplayRecordingName = GetReplayRecordingName();
+	UGameInstance* ServerGameInstance = ServerWorld ? ServerWorld->GetGameInstance() : nullptr;
+	if (ReplayRecordingName.IsEmpty() == false && ServerGameInstance)
+	{
+		ServerGameInstance->StartRecordingReplay(ReplayRecordingName, ReplayRecordingName);
+		if (ServerWorld->GetDemoNetDriver() == nullptr)
+		{
+			TestContext.AddError(FString::Printf(TEXT("Failed to start recording replay '%s'"), *ReplayRecordingName));
+		}
+	}
+
+	const FUntestReplicationAuditOpts AuditOpts = GetReplicationAuditOpts();
+	TestContext.ReplicationAuditor.Reset();
+	if (AuditOpts.bEnabled && ServerWorld)
+	{
+		TestContext.ReplicationAuditor = MakeShared<FUntestReplicationAuditor>(ServerWorld, AuditOpts);
+	}
+	const FUntestNetTotals StartNetTotals = SampleNetTotals(TestContext.Worlds);
+	FUntestNetTotals LastNetTotals = StartNetTotals;
+
+	// Fixed rate worlds bank the real time that passed and tick in steps of 1/Hz, so a 30Hz server and 120Hz clients
+	// tick at their own rates regardless of how often the fixture itself runs
+	TArray<FUntestTickRate> TickRates;
+	TArray<double> BankedSeconds;
+	TArray<int32> DroppedTicks;
+	for (int32 TestWorldType = EUntestWorldType::Server; TestWorldType < Tasks.Num(); ++TestWorldType)
+	{
+		TickRates.Emplace(GetTickRate(static_cast<EUntestWorldType::Enum>(TestWorldType)));
+	}
+	BankedSeconds.SetNumZeroed(Tasks.Num());
+	DroppedTicks.SetNumZeroed(Tasks.Num());
+
+	auto Func = [&TestContext, &Tasks, RunBegin, &LastTimestamp, &NumServerTicks, &TotalServerTickMs, &MaxServerTickMs, &StartNetTotals, &LastNetTotals, &TickRates, &BankedSeconds, &DroppedTicks]()
 	{
 		const double Now = FPlatformTime::Seconds();
 		const double DeltaSeconds = Now - LastTimestamp;
 		LastTimestamp = Now;
 
-		FUntestContext& TestContext = GetContext();
+		++TestContext.FrameNumber;
 
-		TestContext.Worlds[EUntestWorldType::Server]->Tick(LEVELTICK_All, DeltaSeconds);
-		ServerTask.Resume();
+		bool bAllDone = true;
+		for (int32 TestWorldType = EUntestWorldType::Server; TestWorldType < Tasks.Num(); ++TestWorldType)
+		{
+			const FUntestTickRate& TickRate = TickRates[TestWorldType];
 
-		TestContext.Worlds[EUntestWorldType::Client]->Tick(LEVELTICK_All, DeltaSeconds);
-		ClientTask.Resume();
+			int32 NumTicks = 1;
+			double TickDeltaSeconds = DeltaSeconds;
+			if (TickRate.Hz > 0.0f)
+			{
+				TickDeltaSeconds = 1.0 / TickRate.Hz;
+				BankedSeconds[TestWorldType] += DeltaSeconds;
+
+				const int32 DueTicks = FMath::FloorToInt32(BankedSeconds[TestWorldType] / TickDeltaSeconds);
+				BankedSeconds[TestWorldType] -= DueTicks * TickDeltaSeconds;
+
+				// Like a real server that can't keep up, ticks beyond the substep limit are skipped rather than caught up on
+				NumTicks = FMath::Min(DueTicks, FMath::Max(TickRate.MaxSubsteps, 1));
+				DroppedTicks[TestWorldType] += DueTicks - NumTicks;
+			}
+
+			for (int32 Tick = 0; Tick < NumTicks; ++Tick)
+			{
+				const double TickBegin = FPlatformTime::Seconds();
+				TestContext.Worlds[TestWorldType]->Tick(LEVELTICK_All, static_cast<float>(TickDeltaSeconds));
+
+				if (TestWorldType == EUntestWorldType::Server)
+				{
+					const double TickMs = (FPlatformTime::Seconds() - TickBegin) * 1000.0;
+					TotalServerTickMs += TickMs;
+					MaxServerTickMs = FMath::Max(MaxServerTickMs, TickMs);
+					++NumServerTicks;
+
+					// Sampled before the tests resume so budget checks see this tick's replication
+					const FUntestNetTotals NetTotals = SampleNetTotals(TestContext.Worlds);
+					UpdateNetStats(TestContext.NetStats, StartNetTotals, LastNetTotals, NetTotals, Now - RunBegin);
+					SampleRoundTripTimes(TestContext.NetStats, TestContext.Worlds);
+					LastNetTotals = NetTotals;
+
+					if (TestContext.ReplicationAuditor.IsValid())
+					{
+						TestContext.ReplicationAuditor->Sample();
+					}
+				}
+
+				// Each world's test code runs once per tick of its own world
+				Tasks[TestWorldType].Resume();
+			}
 
-		const bool bIsServerDone = ServerTask.IsDone();
-		const bool bIsClientDone = ClientTask.IsDone();
-		return bIsServerDone && bIsClientDone;
+			bAllDone &= Tasks[TestWorldType].IsDone();
+		}
+		return bAllDone;
 	};
 
 	co_await Squid::WaitUntil(Func);
+
+	RecordReplicationGraphMetrics(TestContext, ReplicationGraphProbe.Get());
+
+	if (ReplayRecordingName.IsEmpty() == false && ServerWorld && ServerWorld->GetDemoNetDriver())
+	{
+		ServerGameInstance->StopRecordingReplay();
+	}
+
+	if (TestContext.ReplicationAuditor.IsValid())
+	{
+		TestContext.ReplicationAuditor->RecordMetrics(TestContext);
+	}
+
+	for (int32 TestWorldType = EUntestWorldType::Server; TestWorldType < TickRates.Num(); ++TestWorldType)
+	{
+		if (TickRates[TestWorldType].Hz > 0.0f)
+		{
+			const FString WorldName = (TestWorldType == EUntestWorldType::Server) ? TEXT("Server") : FString::Printf(TEXT("Client%d"), TestWorldType - EUntestWorldType::Client);
+			TestContext.AddMetric(FString::Printf(TEXT("TickRate.%s.Hz"), *WorldName), TickRates[TestWorldType].Hz);
+			TestContext.AddMetric(FString::Printf(TEXT("TickRate.%s.DroppedTicks"), *WorldName), DroppedTicks[TestWorldType]);
+		}
+	}
+
+	// Compare these across tests with different client counts to see how server cost scales with connections
+	if (NumServerTicks > 0)
+	{
+		const double AvgServerTickMs = TotalServerTickMs / NumServerTicks;
+		TestContext.AddMetric(TEXT("Clients"), NumClients);
+		TestContext.AddMetric(TEXT("ServerTicks"), NumServerTicks);
+		TestContext.AddMetric(TEXT("ServerTickMs.Avg"), AvgServerTickMs);
+		TestContext.AddMetric(TEXT("ServerTickMs.Max"), MaxServerTickMs);
+		TestContext.AddMetric(TEXT("ServerTickMs.PerClient"), AvgServerTickMs / FMath::Max(NumClients, 1));
+	}
 }
 
 UntestTask FBVClientServerTestFixture::TeardownFixture(const FString TestName)
@@ -478,6 +1176,24 @@ UntestTask FBVClientServerTestFixture::TeardownFixture(const FString TestName)
 	FUntestContext& TestContext = GetContext();
 	co_await Teardown(TestContext);
 
+	// The pool flushes the reset to the clients and the next test sets its own profile
+	TestContext.SetNetProfile(FUntestNetProfile());
+	TestContext.ReplicationAuditor.Reset();
+
+	UWorld* ServerWorld = TestContext.Worlds[EUntestWorldType::Server].Get();
+	if (ServerWorld && CanReuseClientServer())
+	{
+		DestroyTestObjects();
+
+		co_await FUntestClientServerPool::Get().Release(ServerWorld, [this](UWorld* World, const EUntestWorldType::Enum WorldType)
+			{
+				ResetClientServer(World, WorldType);
+			});
+
+		// The pair belongs to the pool now (or was destroyed by it), so don't let TeardownClientServer() touch it
+		ResetContextWorlds();
+	}
+
 	TeardownClientServer();
 }
 
@@ -485,53 +1201,60 @@ void FBVClientServerTestFixture::TeardownClientServer()
 {
 	FUntestContext& TestContext = GetContext();
 
-	for (TWeakObjectPtr<UObject> ObjPtr : TestContext.Objects)
+	DestroyTestObjects();
+
+	UWorld* ServerWorld = TestContext.GetWorld(EUntestWorldType::Server);
+	if (ServerWorld == nullptr || FUntestClientServerPool::Get().Discard(ServerWorld) == false)
 	{
-		if (UObject* Obj = ObjPtr.Get())
+		// Setup didn't get as far as handing the pair to the pool, so destroy whatever it managed to create
+		FUntestPooledClientServer Pair;
+		Pair.LastTestName = TestContext.GetName().ToFull();
+		Pair.Packages = TestContext.Packages;
+		Pair.GameInstances = TestContext.GameInstances;
+		Pair.Worlds = TestContext.Worlds;
+
+		bool bHasObjects = false;
+		for (int32 TestWorldType = EUntestWorldType::Server; TestWorldType < Pair.NumWorlds(); ++TestWorldType)
 		{
-			Obj->ConditionalBeginDestroy();
+			bHasObjects |= Pair.Packages[TestWorldType].IsValid() || Pair.GameInstances[TestWorldType].IsValid() || Pair.Worlds[TestWorldType].IsValid();
 		}
-	}
-
-	for (int32 TestWorldType = EUntestWorldType::Server; TestWorldType != EUntestWorldType::Count; ++TestWorldType)
-	{
-		UGameInstance* GameInstance = TestContext.GameInstances[TestWorldType].Get();
-		UWorld* World = TestContext.Worlds[TestWorldType].Get();
-		UPackage* Package = TestContext.Packages[TestWorldType].Get();
 
-		if (World)
+		if (bHasObjects)
 		{
-			World->BeginTearingDown();
+			FUntestClientServerPool::Get().Destroy(Pair);
+		}
+	}
 
-			// DestroyWorld doesn't do this and instead waits for GC to clear everything up
-			for (auto It = TActorIterator<AActor>(World); It; ++It)
-			{
-				It->Destroy();
-			}
+	ResetContextWorlds();
+}
 
-			GEngine->DestroyWorldContext(World);
-			World->DestroyWorld(false /*bInformEngineOfWorld*/);
-		}
+void FBVClientServerTestFixture::DestroyTestObjects()
+{
+	FUntestContext& TestContext = GetContext();
 
-		if (GameInstance)
-		{
-			GameInstance->Shutdown();
-			GameInstance->RemoveFromRoot();
-			GameInstance->ConditionalBeginDestroy();
-		}
+	if (TestContext.Objects.Num() > 0)
+	{
+		FUntestGarbageCollector::Get().AddUntrackedGarbage();
+	}
 
-		if (Package)
+	for (TWeakObjectPtr<UObject> ObjPtr : TestContext.Objects)
+	{
+		if (UObject* Obj = ObjPtr.Get())
 		{
-			Package->RemoveFromRoot();
-			Package->ConditionalBeginDestroy();
+			Obj->ConditionalBeginDestroy();
 		}
+	}
+	TestContext.Objects.Reset();
+}
 
+void FBVClientServerTestFixture::ResetContextWorlds()
+{
+	FUntestContext& TestContext = GetContext();
+
+	for (int32 TestWorldType = EUntestWorldType::Server; TestWorldType < TestContext.Worlds.Num(); ++TestWorldType)
+	{
 		TestContext.Worlds[TestWorldType].Reset();
 		TestContext.GameInstances[TestWorldType].Reset();
 		TestContext.Packages[TestWorldType].Reset();
 	}
-
-	FSoftObjectPath::ClearPIEPackageNames();
-
-	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
 }
@@ -0,0 +1,92 @@
+#include "UntestAwaiters.h"
+
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Misc/ScopeExit.h"
+
+Squid::Task<TArray<AActor*>> UntestWaitForActorsOfClass(UWorld* World, UClass* Class, int32 Num, TFunction<bool(AActor*)> Predicate)
+{
+	TArray<AActor*> Result;
+	if (World == nullptr || Class == nullptr)
+	{
+		co_return Result;
+	}
+
+	// Lives in the coroutine frame, so the spawn handler can add to it until the handler is removed on exit
+	TArray<TWeakObjectPtr<AActor>> Pending;
+	TArray<TWeakObjectPtr<AActor>> Accepted;
+
+	for (TActorIterator<AActor> It(World, Class); It; ++It)
+	{
+		Pending.Add(*It);
+	}
+
+	const TWeakObjectPtr<UWorld> WeakWorld = World;
+	const FDelegateHandle SpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateLambda([Class, &Pending](AActor* Actor)
+		{
+			if (Actor->IsA(Class))
+			{
+				Pending.Add(Actor);
+			}
+		}));
+	ON_SCOPE_EXIT
+	{
+		if (UWorld* LiveWorld = WeakWorld.Get())
+		{
+			LiveWorld->RemoveOnActorSpawnedHandler(SpawnedHandle);
+		}
+	};
+
+	auto AcceptPending = [&WeakWorld, &Pending, &Accepted, &Predicate]()
+	{
+		const bool bWorldHasBegunPlay = WeakWorld->HasBegunPlay();
+		for (int32 Index = Pending.Num() - 1; Index >= 0; --Index)
+		{
+			AActor* Actor = Pending[Index].Get();
+			if (IsValid(Actor) == false)
+			{
+				Pending.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			}
+			else if ((bWorldHasBegunPlay == false || Actor->HasActorBegunPlay()) && (!Predicate || Predicate(Actor)))
+			{
+				Accepted.Add(Actor);
+				Pending.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			}
+		}
+	};
+
+	for (;;)
+	{
+		co_await Squid::WaitUntil([&WeakWorld, &Accepted, &AcceptPending, Num]()
+			{
+				if (WeakWorld.IsValid() == false)
+				{
+					return true;
+				}
+				AcceptPending();
+				return Accepted.Num() >= Num;
+			});
+
+		if (WeakWorld.IsValid() == false)
+		{
+			co_return Result;
+		}
+
+		// Accepted actors can have been destroyed since, which means waiting for more
+		Accepted.RemoveAll([](const TWeakObjectPtr<AActor>& Actor)
+			{
+				return IsValid(Actor.Get()) == false;
+			});
+		if (Accepted.Num() >= Num)
+		{
+			break;
+		}
+	}
+
+	Result.Reserve(Accepted.Num());
+	for (const TWeakObjectPtr<AActor>& Actor : Accepted)
+	{
+		Result.Add(Actor.Get());
+	}
+	co_return Result;
+}
@@ -0,0 +1,185 @@
+#include "UntestControlChannel.h"
+
+#include "IPAddress.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+// Time a blocking send keeps retrying when the socket's buffer is full. Messages are small, so this only happens when the
+// other side has stopped reading.
+static constexpr double MaxSendSeconds = 5.0;
+
+FUntestControlChannel::~FUntestControlChannel()
+{
+	Close();
+}
+
+bool FUntestControlChannel::Listen(uint16& OutPort)
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	ListenSocket = SocketSubsystem->CreateSocket(NAME_Stream, TEXT("UntestControlListen"), false);
+	if (ListenSocket == nullptr)
+	{
+		return false;
+	}
+
+	TSharedRef<FInternetAddr> Addr = SocketSubsystem->CreateInternetAddr();
+	Addr->SetLoopbackAddress();
+	Addr->SetPort(0);
+
+	if (ListenSocket->Bind(*Addr) == false || ListenSocket->Listen(1) == false)
+	{
+		Close();
+		return false;
+	}
+	ListenSocket->SetNonBlocking(true);
+
+	OutPort = static_cast<uint16>(ListenSocket->GetPortNo());
+	return OutPort != 0;
+}
+
+bool FUntestControlChannel::TryAccept()
+{
+	if (Socket)
+	{
+		return true;
+	}
+
+	bool bHasPendingConnection = false;
+	if (ListenSocket == nullptr || ListenSocket->HasPendingConnection(bHasPendingConnection) == false || bHasPendingConnection == false)
+	{
+		return false;
+	}
+
+	Socket = ListenSocket->Accept(TEXT("UntestControl"));
+	if (Socket == nullptr)
+	{
+		return false;
+	}
+	Socket->SetNonBlocking(true);
+	Socket->SetNoDelay(true);
+
+	// Only one server process per fixture
+	ListenSocket->Close();
+	ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(ListenSocket);
+	ListenSocket = nullptr;
+	return true;
+}
+
+bool FUntestControlChannel::Connect(uint16 Port)
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	Socket = SocketSubsystem->CreateSocket(NAME_Stream, TEXT("UntestControl"), false);
+	if (Socket == nullptr)
+	{
+		return false;
+	}
+
+	TSharedRef<FInternetAddr> Addr = SocketSubsystem->CreateInternetAddr();
+	Addr->SetLoopbackAddress();
+	Addr->SetPort(Port);
+
+	if (Socket->Connect(*Addr) == false)
+	{
+		Close();
+		return false;
+	}
+	Socket->SetNonBlocking(true);
+	Socket->SetNoDelay(true);
+	return true;
+}
+
+bool FUntestControlChannel::IsConnected() const
+{
+	return Socket && Socket->GetConnectionState() == SCS_Connected;
+}
+
+void FUntestControlChannel::Close()
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	if (Socket)
+	{
+		Socket->Close();
+		SocketSubsystem->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+	if (ListenSocket)
+	{
+		ListenSocket->Close();
+		SocketSubsystem->DestroySocket(ListenSocket);
+		ListenSocket = nullptr;
+	}
+	ReceiveBuffer.Reset();
+}
+
+bool FUntestControlChannel::Send(const TCHAR* Command, const FString& Args)
+{
+	if (Socket == nullptr)
+	{
+		return false;
+	}
+
+	FString Line = Args.IsEmpty() ? FString(Command) : FString::Printf(TEXT("%s %s"), Command, *Args);
+	Line.ReplaceCharInline(TEXT('\r'), TEXT(' '));
+	Line.ReplaceCharInline(TEXT('\n'), TEXT(' '));
+	Line.AppendChar(TEXT('\n'));
+
+	const FTCHARToUTF8 Utf8(*Line);
+	const uint8* Data = reinterpret_cast<const uint8*>(Utf8.Get());
+	int32 Remaining = Utf8.Length();
+
+	const double SendBegin = FPlatformTime::Seconds();
+	while (Remaining > 0)
+	{
+		int32 BytesSent = 0;
+		if (Socket->Send(Data, Remaining, BytesSent) == false || FPlatformTime::Seconds() - SendBegin > MaxSendSeconds)
+		{
+			return false;
+		}
+		Data += BytesSent;
+		Remaining -= BytesSent;
+	}
+	return true;
+}
+
+void FUntestControlChannel::Receive(TArray<FUntestControlMessage>& OutMessages)
+{
+	if (Socket == nullptr)
+	{
+		return;
+	}
+
+	uint32 PendingBytes = 0;
+	while (Socket->HasPendingData(PendingBytes) && PendingBytes > 0)
+	{
+		const int32 Offset = ReceiveBuffer.Num();
+		ReceiveBuffer.AddUninitialized(PendingBytes);
+
+		int32 BytesRead = 0;
+		Socket->Recv(ReceiveBuffer.GetData() + Offset, PendingBytes, BytesRead);
+		ReceiveBuffer.SetNum(Offset + BytesRead, EAllowShrinking::No);
+		if (BytesRead == 0)
+		{
+			break;
+		}
+	}
+
+	int32 LineBegin = 0;
+	for (int32 Index = 0; Index < ReceiveBuffer.Num(); ++Index)
+	{
+		if (ReceiveBuffer[Index] != '\n')
+		{
+			continue;
+		}
+
+		const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(ReceiveBuffer.GetData() + LineBegin), Index - LineBegin);
+		const FString Line(Converted.Length(), Converted.Get());
+		LineBegin = Index + 1;
+
+		FUntestControlMessage& Message = OutMessages.AddDefaulted_GetRef();
+		if (Line.Split(TEXT(" "), &Message.Command, &Message.Args) == false)
+		{
+			Message.Command = Line;
+		}
+	}
+	ReceiveBuffer.RemoveAt(0, LineBegin, EAllowShrinking::No);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FSocket;
+
+struct FUntestControlMessage
+{
+	FString Command;
+	FString Args;
+};
+
+// Line based TCP connection between FUntestDedicatedServerTestFixture and its server process. Each message is one line
+// of text, a command followed by its arguments, e.g. "Metric ServerTickMs.Avg 1.25". Sockets are non-blocking, so
+// both sides poll for messages once per tick.
+class FUntestControlChannel
+{
+public:
+	FUntestControlChannel() = default;
+	~FUntestControlChannel();
+
+	FUntestControlChannel(const FUntestControlChannel&) = delete;
+	FUntestControlChannel& operator=(const FUntestControlChannel&) = delete;
+
+	// Fixture side: listens on a loopback port picked by the OS, then accepts the server process's connection
+	bool Listen(uint16& OutPort);
+	bool TryAccept();
+
+	// Server process side
+	bool Connect(uint16 Port);
+
+	bool IsConnected() const;
+	void Close();
+
+	// Arguments are sent on a single line, so any line breaks in them are replaced with spaces
+	bool Send(const TCHAR* Command, const FString& Args = FString());
+
+	// Appends the messages that have completely arrived since the last call
+	void Receive(TArray<FUntestControlMessage>& OutMessages);
+
+private:
+	FSocket* ListenSocket = nullptr;
+	FSocket* Socket = nullptr;
+	TArray<uint8> ReceiveBuffer; // Start of a message whose line hasn't arrived in full yet
+};
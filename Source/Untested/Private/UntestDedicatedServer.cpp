@@ -0,0 +1,521 @@
+#include "UntestDedicatedServer.h"
+#include "UntestControlChannel.h"
+#include "UntestLoopbackNetDriver.h"
+#include "UntestWorldPool.h"
+
+#include "Engine/Engine.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/NetDriver.h"
+#include "Engine/PendingNetGame.h"
+#include "GameFramework/GameModeBase.h"
+#include "IpNetDriver.h"
+#include "Misc/Paths.h"
+
+// Control channel commands. Fixture to server: Run, Teardown. Server to fixture: Ready <Port>, Error <Text>,
+// Metric <Name> <Value>, RunDone, Done.
+namespace UntestControlCommands
+{
+	static const TCHAR* Ready = TEXT("Ready");
+	static const TCHAR* Run = TEXT("Run");
+	static const TCHAR* Error = TEXT("Error");
+	static const TCHAR* Metric = TEXT("Metric");
+	static const TCHAR* RunDone = TEXT("RunDone");
+	static const TCHAR* Teardown = TEXT("Teardown");
+	static const TCHAR* Done = TEXT("Done");
+} // namespace UntestControlCommands
+
+FUntestDedicatedServerTestFixture::FUntestDedicatedServerTestFixture() = default;
+
+FUntestDedicatedServerTestFixture::~FUntestDedicatedServerTestFixture()
+{
+	// Only does anything when the test didn't get to tear down normally, e.g. it timed out
+	StopServerProcess();
+}
+
+FUntestGameClasses FUntestDedicatedServerTestFixture::GetResolvedGameClasses() const
+{
+	// The in-memory loopback driver can't reach another process, so sockets are the default here
+	const FUntestGameClasses DefaultClasses = GetGameClasses();
+	return {
+		DefaultClasses.GameInstanceClass ? DefaultClasses.GameInstanceClass : TSubclassOf<UUntestGameInstance>(UUntestGameInstance::StaticClass()),
+		DefaultClasses.GameModeClass ? DefaultClasses.GameModeClass : TSubclassOf<AGameModeBase>(AGameModeBase::StaticClass()),
+		DefaultClasses.NetDriverClass ? DefaultClasses.NetDriverClass : TSubclassOf<UNetDriver>(UIpNetDriver::StaticClass()),
+		DefaultClasses.ReplicationDriverClass,
+	};
+}
+
+bool FUntestDedicatedServerTestFixture::CreateServerWorld(const FString& TestName, uint16& OutPort)
+{
+	const FUntestGameClasses Classes = GetResolvedGameClasses();
+
+	// Same names FBVClientServerTestFixture::SetupFixture() gives its worlds. Each process only registers the PIE names of
+	// its own worlds, which is all the remapping of net paths needs.
+	UWorld* World = CreateNetWorld(TestName, EUntestWorldType::Server, Classes);
+	if (World == nullptr)
+	{
+		return false;
+	}
+
+	// See FBVClientServerTestFixture::SetupFixture() for the details of this
+	FURL URL = FURL(nullptr, TEXT("127.0.0.1"), TRAVEL_Absolute);
+	URL.Port = 0;
+
+	World->InitWorld(UWorld::InitializationValues());
+	World->SetGameMode(URL);
+	World->FlushLevelStreaming(EFlushLevelStreamingType::Visibility);
+	World->InitializeActorsForPlay(URL, true /*bResetTime*/, nullptr /*FRegisterComponentContext*/);
+
+	return ListenNetWorld(World, URL, Classes, OutPort);
+}
+
+UntestTask FUntestDedicatedServerTestFixture::ConnectClientWorld(const FString TestName, const EUntestWorldType::Enum WorldType)
+{
+	FUntestContext& TestContext = GetContext();
+	const FUntestGameClasses Classes = GetResolvedGameClasses();
+
+	UWorld* World = CreateNetWorld(TestName, WorldType, Classes);
+	if (World == nullptr)
+	{
+		co_return;
+	}
+	FWorldContext& WorldContext = GEngine->GetWorldContextFromWorldChecked(World);
+
+	// See FBVClientServerTestFixture::SetupFixture() for the details of this. The server answers from its own process, so
+	// there's nothing to tick here but the pending connection.
+	const FString URLString = FString::Printf(TEXT("127.0.0.1:%hu"), ServerPort);
+	FURL URL = FURL(nullptr, *URLString, TRAVEL_Absolute);
+	URL.Port = ServerPort;
+
+	FString ConnectError;
+	UPendingNetGame* PendingNetGame = BeginConnectNetWorld(World, URL, Classes, ConnectError);
+	if (PendingNetGame == nullptr)
+	{
+		TestContext.AddError(FString::Printf(TEXT("Failed to connect client to server process: %s"), *ConnectError));
+		co_return;
+	}
+
+	double LastTimestamp = FPlatformTime::Seconds();
+	auto TryConnectFunc = [this, PendingNetGame, &LastTimestamp]()
+	{
+		const double Now = FPlatformTime::Seconds();
+		PendingNetGame->Tick(Now - LastTimestamp);
+		LastTimestamp = Now;
+
+		ReceiveServerMessages();
+		return PendingNetGame->bSuccessfullyConnected || PendingNetGame->ConnectionError.IsEmpty() == false || bServerDone;
+	};
+	co_await Squid::WaitUntil(TryConnectFunc);
+
+	if (PendingNetGame->bSuccessfullyConnected == false)
+	{
+		TestContext.AddError(FString::Printf(TEXT("Client failed to connect to server process: %s"), *PendingNetGame->ConnectionError));
+		co_return;
+	}
+
+	FinishConnectNetWorld(World, PendingNetGame);
+
+	World->InitializeActorsForPlay(URL, true /*bResetTime*/, nullptr /*FRegisterComponentContext*/);
+
+	// Networked connections require a player controller, which asserts a ULocalPlayer exists
+	ULocalPlayer* NewPlayer = NewObject<ULocalPlayer>(GEngine, ULocalPlayer::StaticClass());
+	UGameInstance* GameInstance = TestContext.GetGameInstance(WorldType);
+	GameInstance->AddLocalPlayer(NewPlayer, IPlatformInputDeviceMapper::Get().GetPrimaryPlatformUser());
+
+	WorldContext.LastURL = URL;
+}
+
+void FUntestDedicatedServerTestFixture::ReceiveServerMessages()
+{
+	if (ControlChannel.IsValid() == false || ControlChannel->TryAccept() == false)
+	{
+		return;
+	}
+
+	FUntestContext& TestContext = GetContext();
+
+	TArray<FUntestControlMessage> Messages;
+	ControlChannel->Receive(Messages);
+	for (const FUntestControlMessage& Message : Messages)
+	{
+		if (Message.Command == UntestControlCommands::Ready)
+		{
+			LexFromString(ServerPort, *Message.Args);
+			bServerReady = true;
+		}
+		else if (Message.Command == UntestControlCommands::Error)
+		{
+			TestContext.AddError(FString::Printf(TEXT("Server: %s"), *Message.Args));
+		}
+		else if (Message.Command == UntestControlCommands::Metric)
+		{
+			FString Name;
+			FString Value;
+			if (Message.Args.Split(TEXT(" "), &Name, &Value, ESearchCase::CaseSensitive, ESearchDir::FromEnd))
+			{
+				TestContext.AddMetric(TEXT("Server.") + Name, FCString::Atod(*Value));
+			}
+		}
+		else if (Message.Command == UntestControlCommands::RunDone)
+		{
+			bServerRunDone = true;
+		}
+		else if (Message.Command == UntestControlCommands::Done)
+		{
+			bServerDone = true;
+		}
+	}
+}
+
+void FUntestDedicatedServerTestFixture::StopServerProcess()
+{
+	if (ControlChannel.IsValid())
+	{
+		ControlChannel->Close();
+	}
+
+	if (ServerProcess.IsValid())
+	{
+		if (FPlatformProcess::IsProcRunning(ServerProcess))
+		{
+			FPlatformProcess::TerminateProc(ServerProcess, true /*KillTree*/);
+		}
+		FPlatformProcess::CloseProc(ServerProcess);
+		ServerProcess.Reset();
+	}
+}
+
+UntestTask FUntestDedicatedServerTestFixture::SetupFixture(const FString TestName)
+{
+	FUntestContext& TestContext = GetContext();
+	const FUntestDedicatedServerOpts Opts = GetDedicatedServerOpts();
+
+	const int32 NumClients = FMath::Max(GetNumClients(), 1);
+	TestContext.SetNumWorlds(EUntestWorldType::Client + NumClients);
+
+	ControlChannel = MakeUnique<FUntestControlChannel>();
+	uint16 ControlPort = 0;
+	if (ControlChannel->Listen(ControlPort) == false)
+	{
+		TestContext.AddError(TEXT("Failed to open a control port for the server process"));
+		co_return;
+	}
+
+	FString Args = FString::Printf(TEXT("\"%s\" -run=UntestServe -Test=%s -ControlPort=%hu -unattended -nullrhi -nosplash -nosound -stdout -FullStdOutLogOutput"),
+		*FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()), *TestName, ControlPort);
+
+	// Comparison runs switch replication systems with a cvar, which the server process has to be started with
+	const EUntestReplicationSystem ReplicationSystem = TestContext.GetReplicationSystem();
+	if (ReplicationSystem != EUntestReplicationSystem::Default)
+	{
+		Args += FString::Printf(TEXT(" -ReplicationSystem=%s -ini:Engine:[ConsoleVariables]:net.Iris.UseIrisReplication=%d"),
+			UntestReplicationSystemStr(ReplicationSystem), (ReplicationSystem == EUntestReplicationSystem::Iris) ? 1 : 0);
+	}
+
+	if (Opts.ExtraArgs.IsEmpty() == false)
+	{
+		Args += TEXT(" ") + Opts.ExtraArgs;
+	}
+
+	UE_LOG(LogUntest, Display, TEXT("%s: starting server process with %s"), *TestName, *Args);
+	ServerProcess = FPlatformProcess::CreateProc(FPlatformProcess::ExecutablePath(), *Args, false /*bLaunchDetached*/, true /*bLaunchHidden*/, true /*bLaunchReallyHidden*/, nullptr, 0, nullptr, nullptr);
+	if (ServerProcess.IsValid() == false)
+	{
+		TestContext.AddError(FString::Printf(TEXT("Failed to start server process %s"), FPlatformProcess::ExecutablePath()));
+		co_return;
+	}
+
+	// Loading the project takes a while, so the process has its own timeout on top of the test's
+	const double StartBegin = FPlatformTime::Seconds();
+	auto IsServerReadyFunc = [this, &Opts, StartBegin]()
+	{
+		ReceiveServerMessages();
+		return bServerReady || bServerDone || FPlatformProcess::IsProcRunning(ServerProcess) == false || FPlatformTime::Seconds() - StartBegin > Opts.StartTimeoutSeconds;
+	};
+	co_await Squid::WaitUntil(IsServerReadyFunc);
+
+	if (bServerReady == false)
+	{
+		if (bServerDone == false)
+		{
+			const bool bIsRunning = FPlatformProcess::IsProcRunning(ServerProcess);
+			TestContext.AddError(bIsRunning ? FString::Printf(TEXT("Server process didn't get ready within %.0fs"), Opts.StartTimeoutSeconds) : TEXT("Server process exited before it got ready"));
+		}
+		co_return;
+	}
+
+	for (int32 TestWorldType = EUntestWorldType::Client; TestWorldType < TestContext.Worlds.Num(); ++TestWorldType)
+	{
+		co_await ConnectClientWorld(TestName, static_cast<EUntestWorldType::Enum>(TestWorldType));
+		if (TestContext.Errors.IsEmpty() == false)
+		{
+			co_return;
+		}
+	}
+
+	// The clients can't see the server's connections, so they wait for their own player controllers instead
+	double LastTimestamp = FPlatformTime::Seconds();
+	auto HaveJoinedFunc = [this, &TestContext, &LastTimestamp]()
+	{
+		const double Now = FPlatformTime::Seconds();
+		const double DeltaSeconds = Now - LastTimestamp;
+		LastTimestamp = Now;
+
+		ReceiveServerMessages();
+
+		bool bClientsHavePlayers = true;
+		for (int32 TestWorldType = EUntestWorldType::Client; TestWorldType < TestContext.Worlds.Num(); ++TestWorldType)
+		{
+			UWorld* World = TestContext.Worlds[TestWorldType].Get();
+			World->Tick(LEVELTICK_All, DeltaSeconds);
+			bClientsHavePlayers &= (World->GetFirstPlayerController() != nullptr);
+		}
+		return bClientsHavePlayers || bServerDone;
+	};
+	co_await Squid::WaitUntil(HaveJoinedFunc);
+
+	if (bServerDone)
+	{
+		TestContext.AddError(TEXT("Server process stopped while the clients were logging in"));
+		co_return;
+	}
+
+	co_await Setup(TestContext);
+}
+
+UntestTask FUntestDedicatedServerTestFixture::RunFixture(const FString TestName)
+{
+	FUntestContext& TestContext = GetContext();
+	const int32 NumClients = TestContext.GetNumClients();
+
+	ControlChannel->Send(UntestControlCommands::Run);
+
+	// One task per client, the server's runs in its own process
+	TArray<UntestTask> Tasks;
+	Tasks.Reserve(NumClients);
+	for (int32 TestWorldType = EUntestWorldType::Client; TestWorldType < TestContext.Worlds.Num(); ++TestWorldType)
+	{
+		Tasks.Emplace(Run(TestContext, static_cast<EUntestWorldType::Enum>(TestWorldType)));
+	}
+
+	int32 NumClientTicks = 0;
+	double TotalClientTickMs = 0.0;
+	double MaxClientTickMs = 0.0;
+	double LastTimestamp = FPlatformTime::Seconds();
+
+	auto Func = [this, &TestContext, &Tasks, &LastTimestamp, &NumClientTicks, &TotalClientTickMs, &MaxClientTickMs]()
+	{
+		const double Now = FPlatformTime::Seconds();
+		const double DeltaSeconds = Now - LastTimestamp;
+		LastTimestamp = Now;
+
+		++TestContext.FrameNumber;
+		ReceiveServerMessages();
+
+		bool bAllDone = true;
+		for (int32 Index = 0; Index < Tasks.Num(); ++Index)
+		{
+			const double TickBegin = FPlatformTime::Seconds();
+			TestContext.Worlds[EUntestWorldType::Client + Index]->Tick(LEVELTICK_All, static_cast<float>(DeltaSeconds));
+			const double TickMs = (FPlatformTime::Seconds() - TickBegin) * 1000.0;
+			TotalClientTickMs += TickMs;
+			MaxClientTickMs = FMath::Max(MaxClientTickMs, TickMs);
+			++NumClientTicks;
+
+			Tasks[Index].Resume();
+			bAllDone &= Tasks[Index].IsDone();
+		}
+
+		if (bServerRunDone == false && (bServerDone || FPlatformProcess::IsProcRunning(ServerProcess) == false))
+		{
+			TestContext.AddError(TEXT("Server process stopped while the test was running"));
+			return true;
+		}
+
+		return bAllDone && bServerRunDone;
+	};
+
+	co_await Squid::WaitUntil(Func);
+
+	if (NumClientTicks > 0)
+	{
+		TestContext.AddMetric(TEXT("Clients"), NumClients);
+		TestContext.AddMetric(TEXT("ClientTickMs.Avg"), TotalClientTickMs / NumClientTicks);
+		TestContext.AddMetric(TEXT("ClientTickMs.Max"), MaxClientTickMs);
+	}
+}
+
+UntestTask FUntestDedicatedServerTestFixture::TeardownFixture(const FString TestName)
+{
+	FUntestContext& TestContext = GetContext();
+	const FUntestDedicatedServerOpts Opts = GetDedicatedServerOpts();
+
+	co_await Teardown(TestContext);
+
+	// The server tears down its half and reports any errors from it, then exits on its own so its log is complete. A
+	// process that never connected is still loading and gets killed right away.
+	if (ControlChannel.IsValid() && ControlChannel->IsConnected())
+	{
+		const double StopBegin = FPlatformTime::Seconds();
+		if (bServerDone == false)
+		{
+			ControlChannel->Send(UntestControlCommands::Teardown);
+		}
+
+		auto HasStoppedFunc = [this, &Opts, StopBegin]()
+		{
+			ReceiveServerMessages();
+			return FPlatformProcess::IsProcRunning(ServerProcess) == false || FPlatformTime::Seconds() - StopBegin > Opts.StopTimeoutSeconds;
+		};
+		co_await Squid::WaitUntil(HasStoppedFunc);
+	}
+
+	StopServerProcess();
+	TeardownClientServer();
+}
+
+UntestTask FUntestDedicatedServerTestFixture::ServeFixture(const FString TestName, uint16 ControlPort)
+{
+	FUntestContext& TestContext = GetContext();
+	const FUntestDedicatedServerOpts Opts = GetDedicatedServerOpts();
+
+	ControlChannel = MakeUnique<FUntestControlChannel>();
+	if (ControlChannel->Connect(ControlPort) == false)
+	{
+		UE_LOG(LogUntest, Error, TEXT("%s: failed to connect to the test's control port %hu"), *TestName, ControlPort);
+		co_return;
+	}
+
+	// Only the server world lives in this process
+	TestContext.SetNumWorlds(EUntestWorldType::Client);
+
+	bool bRun = false;
+	bool bTeardown = false;
+	auto ReceiveFixtureMessages = [this, &bRun, &bTeardown]()
+	{
+		TArray<FUntestControlMessage> Messages;
+		ControlChannel->Receive(Messages);
+		for (const FUntestControlMessage& Message : Messages)
+		{
+			bRun |= (Message.Command == UntestControlCommands::Run);
+			bTeardown |= (Message.Command == UntestControlCommands::Teardown);
+		}
+
+		// The fixture is gone, e.g. its test timed out
+		bTeardown |= (ControlChannel->IsConnected() == false);
+	};
+
+	int32 NumSentErrors = 0;
+	auto SendErrors = [this, &TestContext, &NumSentErrors]()
+	{
+		for (; NumSentErrors < TestContext.Errors.Num(); ++NumSentErrors)
+		{
+			ControlChannel->Send(UntestControlCommands::Error, TestContext.Errors[NumSentErrors]);
+		}
+	};
+
+	// Ticks at a fixed rate like a real dedicated server, where a tick that overruns delays the next one rather than being
+	// caught up on
+	const double TickSeconds = 1.0 / FMath::Max(Opts.ServerTickHz, 1.0f);
+	double NextTickTime = FPlatformTime::Seconds();
+	auto IsTickDue = [TickSeconds, &NextTickTime]()
+	{
+		const double Now = FPlatformTime::Seconds();
+		if (Now < NextTickTime)
+		{
+			return false;
+		}
+		NextTickTime = FMath::Max(NextTickTime + TickSeconds, Now);
+		return true;
+	};
+
+	uint16 Port = 0;
+	const bool bCreated = CreateServerWorld(TestName, Port);
+	if (bCreated)
+	{
+		co_await Setup(TestContext);
+	}
+
+	UWorld* World = TestContext.GetWorld(EUntestWorldType::Server);
+	if (bCreated && TestContext.Errors.IsEmpty())
+	{
+		ControlChannel->Send(UntestControlCommands::Ready, LexToString(Port));
+
+		// Keeps ticking while the clients connect and log in
+		auto WaitForRunFunc = [World, TickSeconds, &ReceiveFixtureMessages, &IsTickDue, &bRun, &bTeardown]()
+		{
+			ReceiveFixtureMessages();
+			if (IsTickDue())
+			{
+				World->Tick(LEVELTICK_All, static_cast<float>(TickSeconds));
+			}
+			return bRun || bTeardown;
+		};
+		co_await Squid::WaitUntil(WaitForRunFunc);
+
+		if (bTeardown == false)
+		{
+			UntestTask Task = Run(TestContext, EUntestWorldType::Server);
+
+			int32 NumServerTicks = 0;
+			double TotalServerTickMs = 0.0;
+			double MaxServerTickMs = 0.0;
+
+			auto RunFunc = [&TestContext, World, TickSeconds, &Task, &ReceiveFixtureMessages, &IsTickDue, &SendErrors, &bTeardown, &NumServerTicks, &TotalServerTickMs, &MaxServerTickMs]()
+			{
+				ReceiveFixtureMessages();
+				if (IsTickDue())
+				{
+					const double TickBegin = FPlatformTime::Seconds();
+					World->Tick(LEVELTICK_All, static_cast<float>(TickSeconds));
+					const double TickMs = (FPlatformTime::Seconds() - TickBegin) * 1000.0;
+					TotalServerTickMs += TickMs;
+					MaxServerTickMs = FMath::Max(MaxServerTickMs, TickMs);
+					++NumServerTicks;
+
+					++TestContext.FrameNumber;
+					Task.Resume();
+					SendErrors();
+				}
+				return Task.IsDone() || bTeardown;
+			};
+			co_await Squid::WaitUntil(RunFunc);
+
+			if (NumServerTicks > 0)
+			{
+				TestContext.AddMetric(TEXT("ServerTicks"), NumServerTicks);
+				TestContext.AddMetric(TEXT("ServerTickMs.Avg"), TotalServerTickMs / NumServerTicks);
+				TestContext.AddMetric(TEXT("ServerTickMs.Max"), MaxServerTickMs);
+			}
+
+			for (const FUntestMetric& Metric : TestContext.GetMetrics())
+			{
+				ControlChannel->Send(UntestControlCommands::Metric, FString::Printf(TEXT("%s %.17g"), *Metric.Name, Metric.Value));
+			}
+			SendErrors();
+			ControlChannel->Send(UntestControlCommands::RunDone);
+		}
+
+		// Keeps ticking until the clients are done too, so their connections stay up
+		auto WaitForTeardownFunc = [World, TickSeconds, &ReceiveFixtureMessages, &IsTickDue, &bTeardown]()
+		{
+			ReceiveFixtureMessages();
+			if (IsTickDue())
+			{
+				World->Tick(LEVELTICK_All, static_cast<float>(TickSeconds));
+			}
+			return bTeardown;
+		};
+		co_await Squid::WaitUntil(WaitForTeardownFunc);
+	}
+
+	if (bCreated)
+	{
+		co_await Teardown(TestContext);
+	}
+
+	SendErrors();
+	ControlChannel->Send(UntestControlCommands::Done);
+	ControlChannel->Close();
+
+	TeardownClientServer();
+}
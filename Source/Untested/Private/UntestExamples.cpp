@@ -1,7 +1,18 @@
 #include "UntestExamples.h"
 #include "Untest.h"
-
+#include "UntestDedicatedServer.h"
+#include "UntestModule.h"
+#include "UntestNetSerialize.h"
+#include "UntestReplay.h"
+#include "UntestReplicationAudit.h"
+#include "UntestReplicationLoad.h"
+#include "UntestWorldPool.h"
+
+#include "BasicReplicationGraph.h"
 #include "Engine/DataTable.h"
+#include "Engine/DemoNetDriver.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/NetDriver.h"
 #include "EngineUtils.h"
 #include "Net/UnrealNetwork.h"
 
@@ -20,24 +31,37 @@ void AUntestExamplePlayerController::GetLifetimeReplicatedProps(TArray<FLifetime
 	DOREPLIFETIME(AUntestExamplePlayerController, ReplicatedInt);
 }
 
+void AUntestExamplePlayerController::ResetTestState()
+{
+	if (HasAuthority())
+	{
+		ReplicatedInt = 0;
+	}
+
+	OnRepReceived.Reset();
+	ServerRpcReceived.Reset();
+	ClientRpcReceived.Reset();
+	MulticastReceived.Reset();
+}
+
 void AUntestExamplePlayerController::OnRep_ReplicatedInt()
 {
-	bWasOnRepCalled = true;
+	OnRepReceived.Trigger();
 }
 
 void AUntestExamplePlayerController::ClientRPC_Implementation()
 {
-	bWasClientRpcCalled = true;
+	ClientRpcReceived.Trigger();
 }
 
 void AUntestExamplePlayerController::ServerRPC_Implementation()
 {
-	bWasServerRpcCalled = true;
+	ServerRpcReceived.Trigger();
 }
 
 void AUntestExamplePlayerController::NetMulticastRPC_Implementation()
 {
-	bWasMulticastCalled = true;
+	MulticastReceived.Trigger();
 }
 
 AUntestExampleGameMode::AUntestExampleGameMode()
@@ -285,6 +309,130 @@ UNTEST_UNIT_F_OPTS(FExampleCustomUnitTestFixture, Untest, Examples, CustomFixtur
 	co_return;
 }
 
+// Shared by every test in Untest.SuiteExamples. Set up once before the first of them runs, and torn down after the last.
+struct FExampleSuite : public FUntestSuite
+{
+	virtual UntestTask Setup(FUntestContext& TestContext) override
+	{
+		++SetupCount;
+		Squares.SetNum(1024);
+		for (int32 Index = 0; Index < Squares.Num(); ++Index)
+		{
+			Squares[Index] = Index * Index;
+		}
+		co_return;
+	}
+
+	virtual void Teardown() override
+	{
+		++TeardownCount;
+		Squares.Empty();
+	}
+
+	TArray<int32> Squares;
+
+	// Over every run, so the tests can tell a suite set up once from one set up again for each test
+	static inline int32 SetupCount = 0;
+	static inline int32 TeardownCount = 0;
+};
+
+UNTEST_SUITE(FExampleSuite, Untest, SuiteExamples);
+
+UNTEST_UNIT(Untest, SuiteExamples, SuiteFirst)
+{
+	FExampleSuite* Suite = TestContext.GetSuite<FExampleSuite>();
+	UNTEST_ASSERT_PTR(Suite);
+	UNTEST_EXPECT_EQ(Suite->Squares[12], 144);
+	co_return;
+}
+
+UNTEST_UNIT(Untest, SuiteExamples, SuiteSecond)
+{
+	FExampleSuite* Suite = TestContext.GetSuite<FExampleSuite>();
+	UNTEST_ASSERT_PTR(Suite);
+	UNTEST_EXPECT_EQ(Suite->Squares.Num(), 1024);
+
+	// Set up once for this run, and not torn down and set up again since the first test
+	UNTEST_EXPECT_EQ(FExampleSuite::SetupCount - FExampleSuite::TeardownCount, 1);
+	co_return;
+}
+
+// Suites are only set up once if their tests run back to back, however they were queued
+UNTEST_UNIT(Untest, SuiteExamples, GroupBySuiteKeepsSuitesTogether)
+{
+	TArray<FString> TestNames = {
+		TEXT("Game.Inventory.Add"),
+		TEXT("Game.Combat.Hit"),
+		TEXT("Game.Inventory.Remove"),
+		TEXT("Game.Combat.Miss"),
+		TEXT("Game.Inventory.Clear"),
+	};
+	FUntestModule::GroupBySuite(TestNames);
+
+	const TArray<FString> Expected = {
+		TEXT("Game.Inventory.Add"),
+		TEXT("Game.Inventory.Remove"),
+		TEXT("Game.Inventory.Clear"),
+		TEXT("Game.Combat.Hit"),
+		TEXT("Game.Combat.Miss"),
+	};
+	UNTEST_EXPECT_EQ(TestNames.Num(), Expected.Num());
+	for (int32 Index = 0; Index < FMath::Min(TestNames.Num(), Expected.Num()); ++Index)
+	{
+		UNTEST_EXPECT_STREQ(*TestNames[Index], *Expected[Index]);
+	}
+	co_return;
+}
+
+bool FUntestExampleCompressedStruct::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint16 CompressedYaw = FRotator::CompressAxisToShort(Yaw);
+	uint8 CrouchedBit = bCrouched ? 1 : 0;
+
+	Ar << Health;
+	Ar << CompressedYaw;
+	Ar.SerializeBits(&CrouchedBit, 1);
+
+	if (Ar.IsLoading())
+	{
+		Yaw = FRotator::DecompressAxisFromShort(CompressedYaw);
+		bCrouched = CrouchedBit != 0;
+	}
+
+	bOutSuccess = true;
+	return true;
+}
+
+struct FExampleNetSerializeFuzzFixture : public TUntestNetSerializeFuzzFixture<FUntestExampleCompressedStruct>
+{
+	// Yaw is only sent as an angle, so values outside [0, 360) come back wrapped
+	virtual void GenerateValue(FUntestExampleCompressedStruct& Value, FRandomStream& Random) const override
+	{
+		TUntestNetSerializeFuzzFixture::GenerateValue(Value, Random);
+		Value.Yaw = Random.FRandRange(0.0f, 360.0f);
+	}
+
+	virtual void MutateValue(FUntestExampleCompressedStruct& Value, FRandomStream& Random) const override
+	{
+		TUntestNetSerializeFuzzFixture::MutateValue(Value, Random);
+		Value.Yaw = FRotator::ClampAxis(Value.Yaw);
+	}
+
+	virtual bool IsEquivalent(const FUntestExampleCompressedStruct& Original, const FUntestExampleCompressedStruct& RoundTripped) const override
+	{
+		const float YawDelta = FMath::Abs(FRotator::NormalizeAxis(Original.Yaw - RoundTripped.Yaw));
+		return Original.Health == RoundTripped.Health && Original.bCrouched == RoundTripped.bCrouched && YawDelta <= 360.0f / 65536.0f;
+	}
+};
+
+UNTEST_UNIT_F_OPTS(FExampleNetSerializeFuzzFixture, Untest, Examples, NetSerializeFuzz, UNTEST_PURE())
+{
+	// 8 bits of health, 16 of yaw and 1 for crouching
+	UNTEST_EXPECT_LE(GetFuzzResults().MaxBits, 25);
+
+	co_return;
+}
+
 UNTEST_WORLD(Untest, Examples, WorldSimple)
 {
 	UGameInstance* GI = UNTEST_GET_GAMEINSTANCE();
@@ -316,6 +464,96 @@ UNTEST_WORLD(Untest, Examples, WorldMakeObjects)
 	UNTEST_EXPECT_EQ(ObjNames.Num(), Tables.Num());
 }
 
+// Tests that only spawn and tick actors don't need physics, navigation or audio, which make up most of a world's setup time
+struct FExampleBareWorldFixture : public FBVWorldTestFixture
+{
+	virtual EUntestWorldProfile GetWorldProfile() const override { return EUntestWorldProfile::Bare; }
+};
+
+UNTEST_WORLD_F(FExampleBareWorldFixture, Untest, Examples, WorldBareProfile)
+{
+	UWorld* World = UNTEST_GET_WORLD();
+	UNTEST_ASSERT_PTR(World);
+
+	UNTEST_EXPECT_NULLPTR(World->GetPhysicsScene());
+	UNTEST_EXPECT_NULLPTR(World->GetNavigationSystem());
+
+	AActor* Actor = World->SpawnActor<AActor>();
+	UNTEST_EXPECT_PTR(Actor);
+}
+
+// Only the first test with this fixture spawns the actors. Later tests get a world restored to the snapshot taken after
+// that Setup(), even if an earlier test moved or tagged the actors.
+struct FExampleSnapshotWorldFixture : public FBVWorldTestFixture
+{
+	static constexpr int32 NumActors = 100;
+
+	virtual FString GetSnapshotKey() const override { return TEXT("ExampleActors"); }
+
+	virtual UntestTask Setup(FUntestContext& TestContext) override
+	{
+		UWorld* World = TestContext.GetWorld(EUntestWorldType::Server);
+		for (int32 Index = 0; Index < NumActors; ++Index)
+		{
+			AActor* Actor = World->SpawnActor<AActor>();
+			Actor->Tags.Add(TEXT("ExampleSnapshot"));
+			Actors.Add(Actor);
+		}
+		co_return;
+	}
+
+	virtual void OnRestoredFromSnapshot(FUntestContext& TestContext) override
+	{
+		bRestoredFromSnapshot = true;
+		for (TActorIterator<AActor> It(TestContext.GetWorld(EUntestWorldType::Server)); It; ++It)
+		{
+			if (It->ActorHasTag(TEXT("ExampleSnapshot")))
+			{
+				Actors.Add(*It);
+			}
+		}
+	}
+
+public:
+	TArray<AActor*> Actors;
+	bool bRestoredFromSnapshot = false;
+};
+
+UNTEST_WORLD_F(FExampleSnapshotWorldFixture, Untest, Examples, WorldSnapshotFirst)
+{
+	UNTEST_ASSERT_EQ(Actors.Num(), NumActors);
+	for (AActor* Actor : Actors)
+	{
+		UNTEST_EXPECT_EQ(Actor->Tags.Num(), 1);
+		Actor->Tags.Add(TEXT("ChangedByTest"));
+	}
+}
+
+// Runs after WorldSnapshotFirst, so it gets that test's world back restored instead of running Setup()
+UNTEST_WORLD_F(FExampleSnapshotWorldFixture, Untest, Examples, WorldSnapshotSecond)
+{
+	if (FUntestWorldPool::Get().IsEnabled())
+	{
+		UNTEST_EXPECT_TRUE(bRestoredFromSnapshot);
+	}
+
+	UNTEST_ASSERT_EQ(Actors.Num(), NumActors);
+	for (AActor* Actor : Actors)
+	{
+		UNTEST_EXPECT_EQ(Actor->Tags.Num(), 1);
+	}
+}
+
+// The map is loaded in the background while earlier tests run, then streamed into the world before the test starts
+UNTEST_WORLD_OPTS(Untest, Examples, WorldMap, UNTEST_MAP("/Engine/Maps/Entry"))
+{
+	UWorld* World = UNTEST_GET_WORLD();
+	UNTEST_ASSERT_PTR(World);
+
+	UNTEST_ASSERT_EQ(World->GetStreamingLevels().Num(), 1);
+	UNTEST_EXPECT_TRUE(World->GetStreamingLevels()[0]->IsLevelVisible());
+}
+
 // This function runs concurrently with a server and client after the client connects.
 UNTEST_CLIENTSERVER(Untest, Examples, ClientServerSimple)
 {
@@ -340,6 +578,30 @@ UNTEST_CLIENTSERVER(Untest, Examples, ClientServerSimple)
 	co_return;
 }
 
+// Runs once for the server and once for each of the four clients, which all connect to the same server world.
+UNTEST_CLIENTSERVER_F_OPTS(TUntestMultiClientFixture<4>, Untest, Examples, ClientServerMultiClient, UNTEST_TIMEOUTMS(5000))
+{
+	UWorld* World = UNTEST_GET_WORLD();
+	UNTEST_ASSERT_PTR(World);
+	UNTEST_EXPECT_EQ(UNTEST_NUM_CLIENTS(), 4);
+
+	if (UNTEST_IS_SERVER())
+	{
+		UNTEST_ASSERT_PTR(World->GetNetDriver());
+		UNTEST_EXPECT_EQ(World->GetNetDriver()->ClientConnections.Num(), 4);
+	}
+
+	if (UNTEST_IS_CLIENT())
+	{
+		UNTEST_EXPECT_GE(UNTEST_CLIENT_INDEX(), 0);
+		UNTEST_EXPECT_LT(UNTEST_CLIENT_INDEX(), 4);
+		UNTEST_EXPECT_EQ(World->GetNetMode(), NM_Client);
+		UNTEST_EXPECT_PTR(World->GetFirstPlayerController());
+	}
+
+	co_return;
+}
+
 struct UntestClientServerReplicationFixture : public FBVClientServerTestFixture
 {
 	virtual FUntestGameClasses GetGameClasses() const override
@@ -349,6 +611,15 @@ struct UntestClientServerReplicationFixture : public FBVClientServerTestFixture
 			AUntestExampleGameMode::StaticClass(), // uses the AUntestExamplePlayerController class
 		};
 	}
+
+	// The player controller is kept when the server/client pair is reused by another test, so clear what this test did to it
+	virtual void ResetClientServer(UWorld* World, const EUntestWorldType::Enum WorldType) override
+	{
+		for (TActorIterator<AUntestExamplePlayerController> It(World); It; ++It)
+		{
+			It->ResetTestState();
+		}
+	}
 };
 
 UNTEST_CLIENTSERVER_F(UntestClientServerReplicationFixture, Untest, Examples, ClientServerReplication)
@@ -357,101 +628,361 @@ UNTEST_CLIENTSERVER_F(UntestClientServerReplicationFixture, Untest, Examples, Cl
 
 	if (UNTEST_IS_SERVER())
 	{
-		AUntestExamplePlayerController* Actor = nullptr;
-		for (TActorIterator<AUntestExamplePlayerController> It(World); It; ++It)
-		{
-			if (AUntestExamplePlayerController* WorldActor = *It)
-			{
-				Actor = WorldActor;
-				break;
-			}
-		}
-
+		AUntestExamplePlayerController* Actor = co_await UntestWaitForActor<AUntestExamplePlayerController>(World);
 		UNTEST_ASSERT_PTR(Actor);
 
 		// yield until server rpc is called from client
-		co_await Squid::WaitUntil([Actor]()
-			{
-				return Actor->bWasServerRpcCalled;
-			});
+		co_await Actor->ServerRpcReceived.Wait();
 
 		Actor->ReplicatedInt = 1337;
-		Actor->bWasServerRpcCalled = false;
 
-		co_await Squid::WaitUntil([Actor]()
-			{
-				return Actor->bWasServerRpcCalled;
-			});
+		co_await Actor->ServerRpcReceived.Wait();
 
-		Actor->bWasServerRpcCalled = false;
 		Actor->ClientRPC();
 
-		co_await Squid::WaitUntil([Actor]()
-			{
-				return Actor->bWasServerRpcCalled;
-			});
+		co_await Actor->ServerRpcReceived.Wait();
 
-		Actor->bWasServerRpcCalled = false;
 		Actor->NetMulticastRPC();
 
-		UNTEST_EXPECT_TRUE(Actor->bWasMulticastCalled);
+		UNTEST_EXPECT_TRUE(Actor->MulticastReceived.IsTriggered());
 
-		co_await Squid::WaitUntil([Actor]()
-			{
-				return Actor->bWasServerRpcCalled;
-			});
+		co_await Actor->ServerRpcReceived.Wait();
+
+		// Budgets are checked against what the server has measured since this test started running
+		UNTEST_EXPECT_NET_OUT_BYTES_PER_SEC_LE(64 * 1024);
+		UNTEST_EXPECT_NET_REPLICATE_MS_PER_FRAME_LE(5.0);
 	}
 
 	if (UNTEST_IS_CLIENT())
 	{
 		// yield until the actor replicated from the server world
-		co_await Squid::WaitUntil([World]()
-			{
-				for (TActorIterator<AUntestExamplePlayerController> It(World); It; ++It)
-				{
-					if (AActor* WorldActor = *It)
-					{
-						return true;
-					}
-				}
-				return false;
-			});
-
-		AUntestExamplePlayerController* Actor = nullptr;
-		for (TActorIterator<AUntestExamplePlayerController> It(World); It; ++It)
-		{
-			if (AUntestExamplePlayerController* WorldActor = *It)
-			{
-				Actor = WorldActor;
-				break;
-			}
-		}
+		AUntestExamplePlayerController* Actor = co_await UntestWaitForActor<AUntestExamplePlayerController>(World);
 		UNTEST_ASSERT_PTR(Actor);
 
 		Actor->ServerRPC();
 
-		co_await Squid::WaitUntil([Actor]()
-			{
-				return Actor->bWasOnRepCalled;
-			});
+		co_await Actor->OnRepReceived.Wait();
 
 		UNTEST_EXPECT_EQ(Actor->ReplicatedInt, 1337);
 		Actor->ServerRPC();
 
-		co_await Squid::WaitUntil([Actor]()
-			{
-				return Actor->bWasClientRpcCalled;
-			});
+		co_await Actor->ClientRpcReceived.Wait();
+
+		Actor->ServerRPC();
+
+		co_await Actor->MulticastReceived.Wait();
 
 		Actor->ServerRPC();
+	}
+
+	co_return;
+}
 
-		co_await Squid::WaitUntil([Actor]()
+// Simulates a poor connection for every test using this fixture. The measured round trip time is written to the report.
+struct UntestClientServerNetProfileFixture : public UntestClientServerReplicationFixture
+{
+	virtual FUntestNetProfile GetNetProfile() const override
+	{
+		FUntestNetProfile Profile;
+		Profile.LatencyMs = 50;
+		Profile.LossPercent = 2;
+		Profile.ReorderPercent = 1;
+		return Profile;
+	}
+};
+
+UNTEST_CLIENTSERVER_F_OPTS(UntestClientServerNetProfileFixture, Untest, Examples, ClientServerNetProfile, UNTEST_TIMEOUTMS(5000))
+{
+	UWorld* World = UNTEST_GET_WORLD();
+
+	AUntestExamplePlayerController* Actor = nullptr;
+	for (TActorIterator<AUntestExamplePlayerController> It(World); It; ++It)
+	{
+		Actor = *It;
+		break;
+	}
+	UNTEST_ASSERT_PTR(Actor);
+
+	if (UNTEST_IS_SERVER())
+	{
+		const double StartSeconds = FPlatformTime::Seconds();
+
+		// Reliable RPCs still arrive under packet loss, just later
+		co_await Actor->ServerRpcReceived.Wait();
+
+		const double ElapsedMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+		UNTEST_EXPECT_GE(ElapsedMs, static_cast<double>(TestContext.GetNetProfile().LatencyMs));
+	}
+
+	if (UNTEST_IS_CLIENT())
+	{
+		Actor->ServerRPC();
+	}
+
+	co_return;
+}
+
+// Measures how many frames an RPC and a property change take to reach the other side
+UNTEST_CLIENTSERVER_F(UntestClientServerReplicationFixture, Untest, Examples, ClientServerLatency)
+{
+	UWorld* World = UNTEST_GET_WORLD();
+
+	AUntestExamplePlayerController* Actor = nullptr;
+	for (TActorIterator<AUntestExamplePlayerController> It(World); It; ++It)
+	{
+		Actor = *It;
+		break;
+	}
+	UNTEST_ASSERT_PTR(Actor);
+
+	if (UNTEST_IS_CLIENT())
+	{
+		TestContext.MarkLatencySend(TEXT("ServerRPC"));
+		Actor->ServerRPC();
+
+		const FUntestLatency RepLatency = co_await TestContext.WaitForLatency(TEXT("OnRep"), [Actor]()
 			{
-				return Actor->bWasMulticastCalled;
+				return Actor->OnRepReceived.IsTriggered();
 			});
+		UNTEST_EXPECT_EQ(Actor->ReplicatedInt, 42);
+		UNTEST_EXPECT_LE(RepLatency.Ticks, 3);
+	}
 
-		Actor->ServerRPC();
+	if (UNTEST_IS_SERVER())
+	{
+		const FUntestLatency RpcLatency = co_await TestContext.WaitForLatency(TEXT("ServerRPC"), [Actor]()
+			{
+				return Actor->ServerRpcReceived.IsTriggered();
+			});
+		UNTEST_EXPECT_LE(RpcLatency.Ticks, 3);
+
+		TestContext.MarkLatencySend(TEXT("OnRep"));
+		Actor->ReplicatedInt = 42;
+	}
+
+	co_return;
+}
+
+struct UntestClientServerReplicationAuditFixture : public FBVClientServerTestFixture
+{
+	virtual FUntestReplicationAuditOpts GetReplicationAuditOpts() const override
+	{
+		FUntestReplicationAuditOpts Opts;
+		Opts.bEnabled = true;
+		Opts.DormancyCandidateFrames = 30;
+		return Opts;
+	}
+};
+
+// Actors that never change should be dormant, so the server doesn't compare their properties every tick
+UNTEST_CLIENTSERVER_F(UntestClientServerReplicationAuditFixture, Untest, Examples, ClientServerReplicationAudit)
+{
+	if (UNTEST_IS_SERVER())
+	{
+		UWorld* World = UNTEST_GET_WORLD();
+		for (int32 Index = 0; Index < 10; ++Index)
+		{
+			AUntestReplicationLoadActor* Actor = World->SpawnActor<AUntestReplicationLoadActor>();
+			Actor->SetNetDormancy(DORM_DormantAll);
+		}
+
+		for (int32 Tick = 0; Tick < 60; ++Tick)
+		{
+			co_await Squid::Suspend();
+		}
+
+		UNTEST_EXPECT_REPLICATION_WASTED_COMPARISONS_LE(AUntestReplicationLoadActor, 0);
+		UNTEST_EXPECT_REPLICATION_DORMANCY_CANDIDATES_LE(AUntestReplicationLoadActor, 0);
+	}
+
+	co_return;
+}
+
+// The same actors left awake are exactly what the audit looks for
+UNTEST_CLIENTSERVER_F(UntestClientServerReplicationAuditFixture, Untest, Examples, ClientServerReplicationAuditFindsAwakeActors)
+{
+	if (UNTEST_IS_SERVER())
+	{
+		UWorld* World = UNTEST_GET_WORLD();
+		for (int32 Index = 0; Index < 10; ++Index)
+		{
+			World->SpawnActor<AUntestReplicationLoadActor>();
+		}
+
+		for (int32 Tick = 0; Tick < 60; ++Tick)
+		{
+			co_await Squid::Suspend();
+		}
+
+		const FUntestReplicationAuditClass Audit = UntestGetReplicationAudit(TestContext, AUntestReplicationLoadActor::StaticClass());
+		UNTEST_EXPECT_EQ(Audit.DormancyCandidates, 10);
+		UNTEST_EXPECT_GT(Audit.WastedComparisons, 0);
+		UNTEST_EXPECT_EQ(Audit.DirtyUnchanged, 0);
 	}
 
 	co_return;
 }
+
+UNTEST_CLIENTSERVER_F(UntestClientServerReplicationAuditFixture, Untest, Examples, ClientServerReplicationAuditFindsDirtyUnchanged)
+{
+	if (UNTEST_IS_SERVER())
+	{
+		UWorld* World = UNTEST_GET_WORLD();
+		AUntestReplicationLoadActor* Actor = World->SpawnActor<AUntestReplicationLoadActor>();
+		co_await Squid::Suspend();
+
+		// Marked dirty every tick, but the value never changes
+		for (int32 Tick = 0; Tick < 10; ++Tick)
+		{
+			Actor->Counter = 0;
+			UNTEST_MARK_PROPERTY_DIRTY_FROM_NAME(AUntestReplicationLoadActor, Counter, Actor);
+			co_await Squid::Suspend();
+		}
+
+		const FUntestReplicationAuditClass Audit = UntestGetReplicationAudit(TestContext, AUntestReplicationLoadActor::StaticClass());
+		UNTEST_EXPECT_GT(Audit.DirtyUnchanged, 0);
+	}
+
+	co_return;
+}
+
+// Runs the server at 30Hz against 120Hz clients, the way they'd tick in production
+struct UntestClientServerTickRateFixture : public FBVClientServerTestFixture
+{
+	virtual FUntestTickRate GetTickRate(const EUntestWorldType::Enum WorldType) const override
+	{
+		FUntestTickRate TickRate;
+		TickRate.Hz = (WorldType == EUntestWorldType::Server) ? 30.0f : 120.0f;
+		return TickRate;
+	}
+};
+
+UNTEST_CLIENTSERVER_F(UntestClientServerTickRateFixture, Untest, Examples, ClientServerTickRates)
+{
+	UWorld* World = UNTEST_GET_WORLD();
+	const float ExpectedDeltaSeconds = UNTEST_IS_SERVER() ? (1.0f / 30.0f) : (1.0f / 120.0f);
+
+	// Run() is resumed after every tick of its own world, and each tick has the fixed delta
+	for (int32 Tick = 0; Tick < 10; ++Tick)
+	{
+		UNTEST_EXPECT_NEAR(World->GetDeltaSeconds(), ExpectedDeltaSeconds, 0.0001f);
+		co_await Squid::Suspend();
+	}
+}
+
+// Records how server replication and client receive cost grow with the number of replicated actors. Real benchmarks
+// would use the default steps of up to 10k actors.
+struct UntestReplicationLoadExampleFixture : public FUntestReplicationLoadFixture
+{
+	virtual FUntestReplicationLoadOpts GetReplicationLoadOpts() const override
+	{
+		FUntestReplicationLoadOpts Opts;
+		Opts.ActorCounts = { 10, 100, 500 };
+		Opts.MeasureTicks = 20;
+		return Opts;
+	}
+};
+
+UNTEST_CLIENTSERVER_F(UntestReplicationLoadExampleFixture, Untest, Examples, ClientServerReplicationLoad)
+{
+	co_await RunReplicationLoad(TestContext, _WorldType);
+}
+
+// Same load through a ReplicationGraph. The RepGraph.* metrics split each connection's cost into gathering and
+// prioritizing, so node policies can be compared against the ReplicationLoad.* numbers of the default driver.
+struct UntestReplicationGraphExampleFixture : public UntestReplicationLoadExampleFixture
+{
+	virtual FUntestGameClasses GetGameClasses() const override
+	{
+		FUntestGameClasses Classes;
+		Classes.ReplicationDriverClass = UBasicReplicationGraph::StaticClass();
+		return Classes;
+	}
+};
+
+UNTEST_CLIENTSERVER_F(UntestReplicationGraphExampleFixture, Untest, Examples, ClientServerReplicationGraph)
+{
+	co_await RunReplicationLoad(TestContext, _WorldType);
+}
+
+// Records the replication load to a replay, which the ClientServerReplayPlayback test below plays back on its own to
+// measure client-side cost without a server in the same process
+struct UntestRecordReplayExampleFixture : public UntestReplicationLoadExampleFixture
+{
+	virtual FString GetReplayRecordingName() const override { return TEXT("UntestExamplesReplicationLoad"); }
+};
+
+UNTEST_CLIENTSERVER_F(UntestRecordReplayExampleFixture, Untest, Examples, ClientServerRecordReplay)
+{
+	co_await RunReplicationLoad(TestContext, _WorldType);
+}
+
+struct UntestReplayPlaybackExampleFixture : public FUntestReplayTestFixture
+{
+	virtual FUntestReplayOpts GetReplayOpts() const override
+	{
+		FUntestReplayOpts Opts;
+		Opts.ReplayName = TEXT("UntestExamplesReplicationLoad");
+		Opts.RecordedTestName = TEXT("Untest.Examples.ClientServerRecordReplay");
+		return Opts;
+	}
+};
+
+UNTEST_WORLD_F(UntestReplayPlaybackExampleFixture, Untest, Examples, ClientServerReplayPlayback)
+{
+	// The recording's load actors are spawned by playback as they were replicated to clients
+	int32 MaxLoadActors = 0;
+	while (GetDemoNetDriver() && GetDemoNetDriver()->GetDemoCurrentTime() < GetDemoNetDriver()->GetDemoTotalTime())
+	{
+		int32 NumLoadActors = 0;
+		for (TActorIterator<AUntestReplicationLoadActor> It(TestContext.GetWorld(_WorldType)); It; ++It)
+		{
+			++NumLoadActors;
+		}
+		MaxLoadActors = FMath::Max(MaxLoadActors, NumLoadActors);
+		co_await Squid::Suspend();
+	}
+
+	UNTEST_EXPECT_GT(MaxLoadActors, 0);
+}
+
+// Same kind of load with the server in its own process, so the client's receive cost and the server's replication cost
+// are measured without the other side sharing the game thread. Disabled since it starts a second editor process, which
+// takes a while. Run it with -IncludeDisabled.
+struct UntestDedicatedServerExampleFixture : public FUntestDedicatedServerTestFixture
+{
+	static constexpr int32 NumActors = 200;
+	static constexpr int32 MeasureTicks = 60;
+};
+
+UNTEST_CLIENTSERVER_F_OPTS(UntestDedicatedServerExampleFixture, Untest, Examples, ClientServerDedicatedServer, UNTEST_DISABLED())
+{
+	UWorld* World = UNTEST_GET_WORLD();
+
+	if (UNTEST_IS_SERVER())
+	{
+		TArray<AUntestReplicationLoadActor*> Actors;
+		for (int32 Index = 0; Index < NumActors; ++Index)
+		{
+			AUntestReplicationLoadActor* Actor = World->SpawnActor<AUntestReplicationLoadActor>();
+			UNTEST_ASSERT_PTR(Actor);
+			Actors.Add(Actor);
+		}
+
+		// Keeps the actors changing, so there's replication to measure on both sides
+		for (int32 Tick = 0; Tick < MeasureTicks; ++Tick)
+		{
+			for (AUntestReplicationLoadActor* Actor : Actors)
+			{
+				Actor->Churn();
+			}
+			co_await Squid::Suspend();
+		}
+	}
+	else
+	{
+		const TArray<AUntestReplicationLoadActor*> Actors = co_await UntestWaitForActors<AUntestReplicationLoadActor>(World, NumActors);
+
+		UNTEST_EXPECT_EQ(Actors.Num(), NumActors);
+	}
+}
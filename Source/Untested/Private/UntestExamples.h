@@ -2,8 +2,36 @@
 
 #include "GameFramework/PlayerController.h"
 #include "GameFramework/GameModeBase.h"
+#include "UntestAwaiters.h"
 #include "UntestExamples.generated.h"
 
+// Quantizes its properties the way a struct replicated every frame would, to show fuzzing a custom NetSerialize()
+USTRUCT()
+struct FUntestExampleCompressedStruct
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	uint8 Health = 0;
+
+	UPROPERTY()
+	float Yaw = 0.0f;
+
+	UPROPERTY()
+	bool bCrouched = false;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template <>
+struct TStructOpsTypeTraits<FUntestExampleCompressedStruct> : public TStructOpsTypeTraitsBase2<FUntestExampleCompressedStruct>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
 UCLASS()
 class AUntestExampleGameMode : public AGameModeBase
 {
@@ -33,11 +61,15 @@ public:
 	UFUNCTION(NetMulticast, Reliable)
 	void NetMulticastRPC();
 
+	// Called on the server and client when a pooled server/client pair is reset for the next test
+	void ResetTestState();
+
 	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedInt)
 	int32 ReplicatedInt = 0;
 
-	bool bWasOnRepCalled = 0;
-	bool bWasServerRpcCalled = false;
-	bool bWasClientRpcCalled = false;
-	bool bWasMulticastCalled = false;
+	// Triggered on whichever side receives the property change or RPC, for tests to co_await
+	FUntestSignal OnRepReceived;
+	FUntestSignal ServerRpcReceived;
+	FUntestSignal ClientRpcReceived;
+	FUntestSignal MulticastReceived;
 };
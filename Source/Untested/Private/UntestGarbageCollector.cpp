@@ -0,0 +1,172 @@
+#include "UntestGarbageCollector.h"
+#include "Untest.h"
+#include "UntestModule.h"
+
+#include "HAL/PlatformMemory.h"
+#include "UObject/GarbageCollection.h"
+#include "UObject/UObjectGlobals.h"
+
+FUntestGarbageCollector& FUntestGarbageCollector::Get()
+{
+	static FUntestGarbageCollector Collector;
+	return Collector;
+}
+
+void FUntestGarbageCollector::Begin(const FUntestRunOpts& Opts)
+{
+	Policy = Opts.GCPolicy;
+	Interval = FMath::Max(Opts.GCInterval, 1);
+	MemoryThresholdBytes = static_cast<uint64>(FMath::Max(Opts.GCMemoryThresholdMB, 0.0f) * 1024.0f * 1024.0f);
+	PurgeBudgetSeconds = FMath::Max(Opts.GCPurgeBudgetMs, 0.1f) / 1000.0;
+
+	NumTestsSinceCollection = 0;
+	bHasUntrackedGarbage = false;
+	UsedMemoryAfterCollection = FPlatformMemory::GetStats().UsedPhysical;
+	ExpectedObjects.Reset();
+	Leaks.Reset();
+}
+
+void FUntestGarbageCollector::ExpectCollected(const FString& TestName, UObject* Object)
+{
+	if (Object)
+	{
+		ExpectedObjects.Emplace(FExpectedObject{ TestName, Object->GetPathName(), Object });
+	}
+}
+
+bool FUntestGarbageCollector::IsCollectionDue() const
+{
+	// Memory can grow without anything the collector was told about, so the threshold is always checked
+	if (Policy == EUntestGCPolicy::MemoryThreshold)
+	{
+		const uint64 UsedMemory = FPlatformMemory::GetStats().UsedPhysical;
+		return UsedMemory > UsedMemoryAfterCollection && UsedMemory - UsedMemoryAfterCollection >= MemoryThresholdBytes;
+	}
+
+	// Only count tests that actually left garbage behind
+	if (HasGarbage() == false)
+	{
+		return false;
+	}
+
+	switch (Policy)
+	{
+		case EUntestGCPolicy::EveryTest:
+			return true;
+		case EUntestGCPolicy::EveryNTests:
+			return NumTestsSinceCollection >= Interval;
+		case EUntestGCPolicy::MemoryThreshold:
+			break; // Checked above
+		case EUntestGCPolicy::Incremental:
+			// Reachability analysis can't start while the previous purge is still running
+			return bPurgePending == false;
+	}
+	return false;
+}
+
+void FUntestGarbageCollector::OnTestFinished()
+{
+	// Only count tests that actually left garbage behind
+	if (HasGarbage())
+	{
+		++NumTestsSinceCollection;
+	}
+}
+
+void FUntestGarbageCollector::CollectIfNeeded()
+{
+	if (IsCollectionDue())
+	{
+		Collect(Policy != EUntestGCPolicy::Incremental);
+	}
+}
+
+void FUntestGarbageCollector::Tick()
+{
+	if (bPurgePending == false)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestGarbageCollector::IncrementalPurge);
+
+	if (IsIncrementalPurgePending())
+	{
+		IncrementalPurgeGarbage(true /*bUseTimeLimit*/, PurgeBudgetSeconds);
+	}
+
+	if (IsIncrementalPurgePending() == false)
+	{
+		bPurgePending = false;
+		UsedMemoryAfterCollection = FPlatformMemory::GetStats().UsedPhysical;
+		VerifyCollected();
+	}
+}
+
+void FUntestGarbageCollector::Finish()
+{
+	if (ExpectedObjects.IsEmpty() == false || bPurgePending)
+	{
+		Collect(true);
+	}
+}
+
+TArray<FUntestLeak> FUntestGarbageCollector::ConsumeLeaks()
+{
+	return MoveTemp(Leaks);
+}
+
+bool FUntestGarbageCollector::HasGarbage() const
+{
+	return bHasUntrackedGarbage || ExpectedObjects.ContainsByPredicate([](const FExpectedObject& Expected)
+		{
+			return Expected.bCollectionStarted == false;
+		});
+}
+
+void FUntestGarbageCollector::Collect(bool bFullPurge)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestGarbageCollector::Collect);
+
+	for (FExpectedObject& Expected : ExpectedObjects)
+	{
+		Expected.bCollectionStarted = true;
+	}
+
+	NumTestsSinceCollection = 0;
+	bHasUntrackedGarbage = false;
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, bFullPurge);
+
+	if (bFullPurge)
+	{
+		bPurgePending = false;
+		UsedMemoryAfterCollection = FPlatformMemory::GetStats().UsedPhysical;
+		VerifyCollected();
+	}
+	else
+	{
+		bPurgePending = true;
+	}
+}
+
+void FUntestGarbageCollector::VerifyCollected()
+{
+	for (int32 i = 0; i < ExpectedObjects.Num();)
+	{
+		const FExpectedObject& Expected = ExpectedObjects[i];
+		if (Expected.bCollectionStarted == false)
+		{
+			++i;
+			continue;
+		}
+
+		// Objects that are still referenced survive the collection even though they've been destroyed
+		if (Expected.Object.Get(true /*bEvenIfPendingKill*/) != nullptr)
+		{
+			Leaks.Emplace(FUntestLeak{ Expected.TestName, Expected.ObjectName });
+		}
+
+		ExpectedObjects.RemoveAtSwap(i, EAllowShrinking::No);
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+struct FUntestRunOpts;
+enum class EUntestGCPolicy : uint32;
+
+// An object that a test destroyed but that was still alive after a garbage collection
+struct FUntestLeak
+{
+	FString TestName;
+	FString ObjectName;
+};
+
+// A full garbage collection costs far more than most tests, so fixtures and world pools don't collect garbage
+// themselves. They tell this collector which objects they destroyed, and the test module runs collections between
+// tests according to the run's GC policy. Every destroyed world, game instance and package is checked after the
+// collection that should have freed it, so a policy that collects less often can't hide leaked worlds.
+class FUntestGarbageCollector
+{
+public:
+	static FUntestGarbageCollector& Get();
+
+	// Called when a test run starts
+	void Begin(const FUntestRunOpts& Opts);
+
+	// Records an object destroyed on behalf of a test. It must be gone once the next collection has finished.
+	void ExpectCollected(const FString& TestName, UObject* Object);
+
+	// Records that a test left garbage that isn't checked for leaks, e.g. actors destroyed when a pooled world was reset.
+	// It counts towards the policy like tracked objects do.
+	void AddUntrackedGarbage() { bHasUntrackedGarbage = true; }
+
+	// Called once a test has finished and torn down, including tests that finished while others kept running
+	void OnTestFinished();
+
+	// Runs a collection if the policy calls for one. Only called between tests, when no test is running.
+	void CollectIfNeeded();
+
+	// True if CollectIfNeeded() would run a collection now. The test module stops overlapping tests while one is due,
+	// since collections only run once no test is running.
+	bool IsCollectionDue() const;
+
+	// Spreads incremental purging across frames. Called every tick, even while tests are running.
+	void Tick();
+
+	// Runs a final full collection at the end of a test run so every destroyed object gets verified
+	void Finish();
+
+	// Returns the leaks found since the last call
+	TArray<FUntestLeak> ConsumeLeaks();
+
+private:
+	struct FExpectedObject
+	{
+		FString TestName;
+		FString ObjectName;
+		TWeakObjectPtr<UObject> Object;
+		bool bCollectionStarted = false;
+	};
+
+	bool HasGarbage() const;
+	void Collect(bool bFullPurge);
+	void VerifyCollected();
+
+	EUntestGCPolicy Policy = {};
+	int32 Interval = 1;
+	uint64 MemoryThresholdBytes = 0;
+	double PurgeBudgetSeconds = 0.0;
+
+	int32 NumTestsSinceCollection = 0;
+	uint64 UsedMemoryAfterCollection = 0;
+	bool bPurgePending = false;
+	bool bHasUntrackedGarbage = false;
+
+	TArray<FExpectedObject> ExpectedObjects;
+	TArray<FUntestLeak> Leaks;
+};
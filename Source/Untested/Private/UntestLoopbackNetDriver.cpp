@@ -0,0 +1,318 @@
+#include "UntestLoopbackNetDriver.h"
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "IPAddress.h"
+#include "SocketSubsystem.h"
+
+namespace
+{
+	// Servers that are currently listening, by virtual port. Only touched from the game thread.
+	TMap<int32, TWeakObjectPtr<UUntestLoopbackNetDriver>> ListeningDrivers;
+	int32 NextVirtualPort = 1;
+
+	int32 AllocateVirtualPort()
+	{
+		for (int32 Attempt = 0; Attempt < MAX_uint16; ++Attempt)
+		{
+			const int32 Port = NextVirtualPort;
+			NextVirtualPort = (NextVirtualPort % MAX_uint16) + 1;
+
+			const TWeakObjectPtr<UUntestLoopbackNetDriver>* ExistingDriver = ListeningDrivers.Find(Port);
+			if (ExistingDriver == nullptr || !ExistingDriver->IsValid())
+			{
+				return Port;
+			}
+		}
+		return 0;
+	}
+
+	// Addresses are only used to identify connections in logs and the driver's address map; nothing is bound to them
+	TSharedRef<FInternetAddr> MakeLoopbackAddr(int32 Port)
+	{
+		TSharedRef<FInternetAddr> Addr = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+		Addr->SetLoopbackAddress();
+		Addr->SetPort(Port);
+		return Addr;
+	}
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// UUntestLoopbackConnection
+
+void UUntestLoopbackConnection::InitLocalConnection(UNetDriver* InDriver, FSocket* InSocket, const FURL& InURL, EConnectionState InState, int32 InMaxPacket, int32 InPacketOverhead)
+{
+	InitBase(InDriver, InSocket, InURL, InState, (InMaxPacket == 0) ? MAX_PACKET_SIZE : InMaxPacket, (InPacketOverhead == 0) ? 1 : InPacketOverhead);
+	RemoteAddr = MakeLoopbackAddr(InURL.Port);
+	InitLoopback();
+}
+
+void UUntestLoopbackConnection::InitRemoteConnection(UNetDriver* InDriver, FSocket* InSocket, const FURL& InURL, const FInternetAddr& InRemoteAddr, EConnectionState InState, int32 InMaxPacket, int32 InPacketOverhead)
+{
+	InitBase(InDriver, InSocket, InURL, InState, (InMaxPacket == 0) ? MAX_PACKET_SIZE : InMaxPacket, (InPacketOverhead == 0) ? 1 : InPacketOverhead);
+	RemoteAddr = InRemoteAddr.Clone();
+	InitLoopback();
+}
+
+void UUntestLoopbackConnection::InitLoopback()
+{
+	// Packets never leave the process, so there's nothing for a PacketHandler to do, and without one there's no stateless
+	// connect handshake to wait on either. The send buffer reserves room for the handler's bits, so it's rebuilt without them.
+	Handler.Reset();
+	StatelessConnectComponent.Reset();
+	MaxPacketHandlerBits = 0;
+	InitSendBuffer();
+}
+
+void UUntestLoopbackConnection::LowLevelSend(void* Data, int32 CountBits, FOutPacketTraits& Traits)
+{
+	UUntestLoopbackConnection* PeerConnection = Peer.Get();
+	if (PeerConnection == nullptr)
+	{
+		return;
+	}
+
+	const uint8* Bytes = static_cast<const uint8*>(Data);
+	TArray<uint8> Packet(Bytes, FMath::DivideAndRoundUp(CountBits, 8));
+
+	// Latency, loss and duplication are simulated by UNetConnection before packets get here, reordering is up to us
+	const UUntestLoopbackNetDriver* LoopbackDriver = Cast<UUntestLoopbackNetDriver>(Driver);
+	const int32 ReorderPercent = LoopbackDriver ? LoopbackDriver->GetReorderPercent() : 0;
+	if (HeldPacket.Num() == 0 && ReorderPercent > 0 && FMath::RandRange(1, 100) <= ReorderPercent)
+	{
+		HeldPacket = MoveTemp(Packet);
+		return;
+	}
+
+	PeerConnection->IncomingPackets.Enqueue(MoveTemp(Packet));
+	ReleaseHeldPacket();
+}
+
+void UUntestLoopbackConnection::ReleaseHeldPacket()
+{
+	UUntestLoopbackConnection* PeerConnection = Peer.Get();
+	if (PeerConnection && HeldPacket.Num() > 0)
+	{
+		PeerConnection->IncomingPackets.Enqueue(MoveTemp(HeldPacket));
+	}
+	HeldPacket.Reset();
+}
+
+void UUntestLoopbackConnection::ReceiveQueuedPackets()
+{
+	TArray<uint8> Packet;
+	while (IncomingPackets.Dequeue(Packet))
+	{
+		if (GetConnectionState() == USOCK_Closed)
+		{
+			IncomingPackets.Empty();
+			return;
+		}
+
+		if (GetConnectionState() == USOCK_Pending)
+		{
+			SetConnectionState(USOCK_Open);
+		}
+
+		ReceivedRawPacket(Packet.GetData(), Packet.Num());
+	}
+}
+
+FString UUntestLoopbackConnection::LowLevelGetRemoteAddress(bool bAppendPort)
+{
+	return RemoteAddr.IsValid() ? RemoteAddr->ToString(bAppendPort) : FString();
+}
+
+FString UUntestLoopbackConnection::LowLevelDescribe()
+{
+	return FString::Printf(TEXT("Loopback remote: %s"), *LowLevelGetRemoteAddress(true));
+}
+
+void UUntestLoopbackConnection::CleanUp()
+{
+	// A socket peer would only find out through a timeout, and tests run with timeouts disabled, so close the other end
+	// right away. The pools check connection state to decide whether a server/client pair can be reused.
+	if (UUntestLoopbackConnection* PeerConnection = Peer.Get())
+	{
+		PeerConnection->Peer.Reset();
+		PeerConnection->SetConnectionState(USOCK_Closed);
+	}
+	Peer.Reset();
+	IncomingPackets.Empty();
+	HeldPacket.Reset();
+
+	Super::CleanUp();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// UUntestLoopbackNetDriver
+
+UUntestLoopbackNetDriver::UUntestLoopbackNetDriver()
+{
+	NetConnectionClass = UUntestLoopbackConnection::StaticClass();
+}
+
+FName UUntestLoopbackNetDriver::RegisterDefinition(TSubclassOf<UNetDriver> DriverClass)
+{
+	check(DriverClass);
+
+	const FName DefinitionName = *FString::Printf(TEXT("Untest_%s"), *DriverClass->GetName());
+	const bool bIsRegistered = GEngine->NetDriverDefinitions.ContainsByPredicate([DefinitionName](const FNetDriverDefinition& Definition) {
+		return Definition.DefName == DefinitionName;
+	});
+
+	if (!bIsRegistered)
+	{
+		FNetDriverDefinition& Definition = GEngine->NetDriverDefinitions.AddDefaulted_GetRef();
+		Definition.DefName = DefinitionName;
+		Definition.DriverClassName = *DriverClass->GetPathName();
+		Definition.DriverClassNameFallback = Definition.DriverClassName;
+	}
+
+	return DefinitionName;
+}
+
+bool UUntestLoopbackNetDriver::InitConnect(FNetworkNotify* InNotify, const FURL& ConnectURL, FString& Error)
+{
+	if (!InitBase(true, InNotify, ConnectURL, false, Error))
+	{
+		return false;
+	}
+
+	const TWeakObjectPtr<UUntestLoopbackNetDriver>* ServerDriver = ListeningDrivers.Find(ConnectURL.Port);
+	if (ServerDriver == nullptr || !ServerDriver->IsValid())
+	{
+		Error = FString::Printf(TEXT("No loopback server is listening on port %d"), ConnectURL.Port);
+		return false;
+	}
+
+	UUntestLoopbackConnection* Connection = NewObject<UUntestLoopbackConnection>(GetTransientPackage(), NetConnectionClass);
+	ServerConnection = Connection;
+	Connection->InitLocalConnection(this, nullptr, ConnectURL, USOCK_Pending);
+	CreateInitialClientChannels();
+
+	Connection->SetPeer((*ServerDriver)->AcceptConnection(Connection));
+	return true;
+}
+
+bool UUntestLoopbackNetDriver::InitListen(FNetworkNotify* InNotify, FURL& LocalURL, bool bReuseAddressAndPort, FString& Error)
+{
+	if (!InitBase(false, InNotify, LocalURL, bReuseAddressAndPort, Error))
+	{
+		return false;
+	}
+
+	// Port 0 asks for any free port, the same as it would for a socket
+	int32 Port = LocalURL.Port;
+	if (Port == 0)
+	{
+		Port = AllocateVirtualPort();
+	}
+
+	const TWeakObjectPtr<UUntestLoopbackNetDriver>* ExistingDriver = ListeningDrivers.Find(Port);
+	if (Port == 0 || (ExistingDriver != nullptr && ExistingDriver->IsValid()))
+	{
+		Error = FString::Printf(TEXT("Loopback port %d is not available"), Port);
+		return false;
+	}
+
+	ListeningDrivers.Add(Port, this);
+	ListenPort = Port;
+	LocalURL.Port = Port;
+	LocalAddr = MakeLoopbackAddr(Port);
+	return true;
+}
+
+UUntestLoopbackConnection* UUntestLoopbackNetDriver::AcceptConnection(UUntestLoopbackConnection* ClientConnection)
+{
+	// Each client gets its own remote address so connections stay distinct in the driver's address map
+	++NumAcceptedConnections;
+
+	UUntestLoopbackConnection* Connection = NewObject<UUntestLoopbackConnection>(GetTransientPackage(), NetConnectionClass);
+	Connection->InitRemoteConnection(this, nullptr, World ? World->URL : FURL(), *MakeLoopbackAddr(NumAcceptedConnections), USOCK_Open);
+	Connection->SetPeer(ClientConnection);
+
+	Notify->NotifyAcceptedConnection(Connection);
+	AddClientConnection(Connection);
+	return Connection;
+}
+
+void UUntestLoopbackNetDriver::TickDispatch(float DeltaTime)
+{
+	Super::TickDispatch(DeltaTime);
+
+	const double ReceiveBegin = FPlatformTime::Seconds();
+
+	if (UUntestLoopbackConnection* Connection = Cast<UUntestLoopbackConnection>(ServerConnection))
+	{
+		Connection->ReleaseHeldPacket();
+		Connection->ReceiveQueuedPackets();
+	}
+
+	// Receiving can close connections, which removes them from ClientConnections
+	const auto Connections = ClientConnections;
+	for (UNetConnection* Connection : Connections)
+	{
+		if (UUntestLoopbackConnection* LoopbackConnection = Cast<UUntestLoopbackConnection>(Connection))
+		{
+			LoopbackConnection->ReleaseHeldPacket();
+			LoopbackConnection->ReceiveQueuedPackets();
+		}
+	}
+
+	Counters.ReceiveSeconds += FPlatformTime::Seconds() - ReceiveBegin;
+}
+
+FString UUntestLoopbackNetDriver::LowLevelGetNetworkNumber()
+{
+	return LocalAddr.IsValid() ? LocalAddr->ToString(true) : FString();
+}
+
+void UUntestLoopbackNetDriver::LowLevelDestroy()
+{
+	Super::LowLevelDestroy();
+
+	const TWeakObjectPtr<UUntestLoopbackNetDriver>* RegisteredDriver = ListeningDrivers.Find(ListenPort);
+	if (RegisteredDriver != nullptr && RegisteredDriver->Get() == this)
+	{
+		ListeningDrivers.Remove(ListenPort);
+	}
+	ListenPort = 0;
+}
+
+ISocketSubsystem* UUntestLoopbackNetDriver::GetSocketSubsystem()
+{
+	// Only used by the engine to create addresses; the loopback driver never opens a socket
+	return ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+}
+
+void UUntestLoopbackNetDriver::TickFlush(float DeltaSeconds)
+{
+	// Iris replicates from within TickFlush() and never calls ServerReplicateActors(). Its update can't be timed on its
+	// own, so this includes flushing the connections, which only queues packets in memory for the loopback driver.
+	if (IsServer() && IsUsingIrisReplication())
+	{
+		const double TimestampBegin = FPlatformTime::Seconds();
+		Super::TickFlush(DeltaSeconds);
+		Counters.ReplicateActorsSeconds += FPlatformTime::Seconds() - TimestampBegin;
+		return;
+	}
+
+	Super::TickFlush(DeltaSeconds);
+}
+
+int32 UUntestLoopbackNetDriver::ServerReplicateActors(float DeltaSeconds)
+{
+	const double TimestampBegin = FPlatformTime::Seconds();
+	const int32 NumReplicated = Super::ServerReplicateActors(DeltaSeconds);
+	Counters.ReplicateActorsSeconds += FPlatformTime::Seconds() - TimestampBegin;
+	Counters.ReplicatedActors += FMath::Max(NumReplicated, 0);
+	PostServerReplicateActors.Broadcast();
+	return NumReplicated;
+}
+
+void UUntestLoopbackNetDriver::ProcessRemoteFunction(AActor* Actor, UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack, UObject* SubObject)
+{
+	++Counters.RemoteFunctions;
+	Super::ProcessRemoteFunction(Actor, Function, Parameters, OutParms, Stack, SubObject);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Containers/Queue.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "UntestLoopbackNetDriver.generated.h"
+
+// Connection half of the loopback driver. Outgoing packets are pushed straight onto the peer connection's queue, which
+// its driver drains on the next TickDispatch(). There's no PacketHandler, so no stateless handshake is needed either.
+UCLASS(Transient)
+class UUntestLoopbackConnection : public UNetConnection
+{
+	GENERATED_BODY()
+
+public:
+	// UNetConnection
+	virtual void InitLocalConnection(UNetDriver* InDriver, FSocket* InSocket, const FURL& InURL, EConnectionState InState, int32 InMaxPacket = 0, int32 InPacketOverhead = 0) override;
+	virtual void InitRemoteConnection(UNetDriver* InDriver, FSocket* InSocket, const FURL& InURL, const FInternetAddr& InRemoteAddr, EConnectionState InState, int32 InMaxPacket = 0, int32 InPacketOverhead = 0) override;
+	virtual void LowLevelSend(void* Data, int32 CountBits, FOutPacketTraits& Traits) override;
+	virtual FString LowLevelGetRemoteAddress(bool bAppendPort = false) override;
+	virtual FString LowLevelDescribe() override;
+	virtual void CleanUp() override;
+
+	void SetPeer(UUntestLoopbackConnection* InPeer) { Peer = InPeer; }
+	void ReceiveQueuedPackets();
+	void ReleaseHeldPacket();
+
+private:
+	void InitLoopback();
+
+	// Filled by the peer connection, drained by our own driver. Both sides currently live on the game thread, but the
+	// queue is single producer/single consumer safe if either driver is ever ticked elsewhere.
+	TQueue<TArray<uint8>, EQueueMode::Spsc> IncomingPackets;
+	TWeakObjectPtr<UUntestLoopbackConnection> Peer;
+
+	// Packet held back to simulate reordering. Sent after the next packet, or on the driver's next tick if none follows.
+	TArray<uint8> HeldPacket;
+};
+
+// Replication work done by a loopback driver since it was created, sampled by the ClientServer fixture for its net stats
+struct FUntestLoopbackNetCounters
+{
+	uint64 RemoteFunctions = 0;	  // RPCs sent by this driver
+	uint64 ReplicatedActors = 0;  // Summed over every ServerReplicateActors() call. Generic replication only.
+	double ReplicateActorsSeconds = 0.0; // ServerReplicateActors(), or with Iris the server's whole TickFlush()
+	double ReceiveSeconds = 0.0; // Time spent processing incoming packets
+};
+
+DECLARE_MULTICAST_DELEGATE(FUntestOnPostServerReplicateActors);
+
+// In-process NetDriver for ClientServer tests. Servers register under a virtual port instead of binding a socket, and
+// connecting clients are paired with a server-side connection immediately, so a client is logged in after a couple of
+// ticks and no OS networking is involved at all.
+UCLASS(Transient)
+class UUntestLoopbackNetDriver : public UNetDriver
+{
+	GENERATED_BODY()
+
+public:
+	UUntestLoopbackNetDriver();
+
+	// Name of the NetDriverDefinition registered with GEngine for DriverClass, used with UEngine::CreateNamedNetDriver()
+	static FName RegisterDefinition(TSubclassOf<UNetDriver> DriverClass);
+
+	// UNetDriver
+	virtual bool IsAvailable() const override { return true; }
+	virtual bool InitConnect(FNetworkNotify* InNotify, const FURL& ConnectURL, FString& Error) override;
+	virtual bool InitListen(FNetworkNotify* InNotify, FURL& LocalURL, bool bReuseAddressAndPort, FString& Error) override;
+	virtual void TickDispatch(float DeltaTime) override;
+	virtual void TickFlush(float DeltaSeconds) override;
+	virtual FString LowLevelGetNetworkNumber() override;
+	virtual void LowLevelDestroy() override;
+	virtual bool IsNetResourceValid() override { return true; }
+	virtual ISocketSubsystem* GetSocketSubsystem() override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+	virtual void ProcessRemoteFunction(AActor* Actor, UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack, UObject* SubObject = nullptr) override;
+
+	const FUntestLoopbackNetCounters& GetCounters() const { return Counters; }
+
+	void SetReorderPercent(int32 InReorderPercent) { ReorderPercent = FMath::Clamp(InReorderPercent, 0, 100); }
+	int32 GetReorderPercent() const { return ReorderPercent; }
+
+	// Broadcast after every ServerReplicateActors(), once all connections have been replicated. Never with Iris.
+	FUntestOnPostServerReplicateActors& OnPostServerReplicateActors() { return PostServerReplicateActors; }
+
+private:
+	UUntestLoopbackConnection* AcceptConnection(UUntestLoopbackConnection* ClientConnection);
+
+	int32 ListenPort = 0;
+	int32 NumAcceptedConnections = 0;
+	FUntestLoopbackNetCounters Counters;
+	int32 ReorderPercent = 0;
+	FUntestOnPostServerReplicateActors PostServerReplicateActors;
+};
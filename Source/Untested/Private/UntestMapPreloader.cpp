@@ -0,0 +1,117 @@
+#include "UntestMapPreloader.h"
+
+#include "Engine/LevelStreamingDynamic.h"
+#include "Engine/World.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+
+FUntestMapPreloader& FUntestMapPreloader::Get()
+{
+	static FUntestMapPreloader Preloader;
+	return Preloader;
+}
+
+void FUntestMapPreloader::Preload(const FString& MapPackageName)
+{
+	if (MapPackageName.IsEmpty() || Loads.Contains(MapPackageName))
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestMapPreloader::Preload);
+
+	TSharedRef<FMapLoad> Load = MakeShared<FMapLoad>();
+	Loads.Emplace(MapPackageName, Load);
+
+	if (FPackageName::DoesPackageExist(MapPackageName) == false)
+	{
+		Load->bDone = true;
+		Load->bFailed = true;
+		return;
+	}
+
+	// The load holds on to its state, so the callback is safe to run after Empty()
+	LoadPackageAsync(MapPackageName, FLoadPackageAsyncDelegate::CreateLambda([Load](const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result)
+		{
+			Load->bDone = true;
+			Load->bFailed = (Result != EAsyncLoadingResult::Succeeded) || (Package == nullptr);
+			if (Load->bFailed == false)
+			{
+				Load->Package.Reset(Package);
+			}
+		}));
+}
+
+Squid::Task<bool> FUntestMapPreloader::WaitUntilLoaded(FString MapPackageName, FUntestContext& TestContext)
+{
+	Preload(MapPackageName);
+
+	const TSharedRef<FMapLoad> Load = Loads.FindChecked(MapPackageName);
+	if (Load->bDone == false)
+	{
+		const double WaitBegin = FPlatformTime::Seconds();
+		co_await Squid::WaitUntil([&Load]()
+			{
+				return Load->bDone;
+			});
+
+		// Time the test spent waiting because its map wasn't preloaded in time
+		TestContext.AddMetric(TEXT("MapWaitMs"), (FPlatformTime::Seconds() - WaitBegin) * 1000.0);
+	}
+
+	if (Load->bFailed)
+	{
+		TestContext.AddError(FString::Printf(TEXT("Failed to load map %s"), *MapPackageName));
+		co_return false;
+	}
+	co_return true;
+}
+
+void FUntestMapPreloader::Empty()
+{
+	Loads.Reset();
+}
+
+ULevelStreamingDynamic* UntestLoadMapInstance(UWorld* World, const FString& MapPackageName, const FString& LevelName)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UntestLoadMapInstance);
+
+	bool bSuccess = false;
+	ULevelStreamingDynamic* StreamingLevel = ULevelStreamingDynamic::LoadLevelInstance(World, MapPackageName, FVector::ZeroVector, FRotator::ZeroRotator, bSuccess, LevelName);
+	if (bSuccess == false || StreamingLevel == nullptr)
+	{
+		return nullptr;
+	}
+
+	StreamingLevel->SetShouldBeVisible(true);
+	StreamingLevel->bShouldBlockOnLoad = false;
+	return StreamingLevel;
+}
+
+Squid::Task<bool> UntestWaitForMapInstance(UWorld* World, ULevelStreamingDynamic* StreamingLevel)
+{
+	TWeakObjectPtr<UWorld> WeakWorld = World;
+	TWeakObjectPtr<ULevelStreamingDynamic> WeakStreamingLevel = StreamingLevel;
+
+	// The world isn't ticking yet, so streaming has to be updated here until the level's package has loaded
+	co_await Squid::WaitUntil([&WeakWorld, &WeakStreamingLevel]()
+		{
+			if (WeakWorld.IsValid() == false || WeakStreamingLevel.IsValid() == false)
+			{
+				return true;
+			}
+			WeakWorld->UpdateLevelStreaming();
+			const ELevelStreamingState State = WeakStreamingLevel->GetLevelStreamingState();
+			return WeakStreamingLevel->HasLoadedLevel() || State == ELevelStreamingState::FailedToLoad;
+		});
+
+	if (WeakWorld.IsValid() == false || WeakStreamingLevel.IsValid() == false || WeakStreamingLevel->HasLoadedLevel() == false)
+	{
+		co_return false;
+	}
+
+	// Only adds the loaded level to the world, so this doesn't block on loading
+	WeakWorld->FlushLevelStreaming(EFlushLevelStreamingType::Visibility);
+	co_return WeakStreamingLevel->IsLevelVisible();
+}
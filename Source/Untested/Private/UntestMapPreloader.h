@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Untest.h"
+#include "UObject/StrongObjectPtr.h"
+
+class ULevelStreamingDynamic;
+class UPackage;
+class UWorld;
+
+// Loading a map and the content it references synchronously while a test sets up its world can cost seconds, which
+// counts against the test's timeout and hides the cost of the test itself. The test module asks this preloader to load
+// the maps of queued tests in the background while earlier tests run, so by the time a test creates its world the map's
+// dependencies are already in memory. Loaded maps are kept until the end of the run, so tests sharing a map load it once.
+class FUntestMapPreloader
+{
+public:
+	static FUntestMapPreloader& Get();
+
+	// Starts loading the map package asynchronously, unless it's already loading or loaded
+	void Preload(const FString& MapPackageName);
+
+	// Resumes once the map package has finished loading, starting the load if it wasn't preloaded. Adds an error to the
+	// test and returns false if the map doesn't exist or failed to load.
+	Squid::Task<bool> WaitUntilLoaded(FString MapPackageName, FUntestContext& TestContext);
+
+	// Releases all loaded maps. Called at the end of every test run.
+	void Empty();
+
+private:
+	struct FMapLoad
+	{
+		bool bDone = false;
+		bool bFailed = false;
+		TStrongObjectPtr<UPackage> Package;
+	};
+
+	TMap<FString, TSharedRef<FMapLoad>> Loads;
+};
+
+// Streams an instance of the map into World. ClientServer worlds pass the same LevelName on every side, so the level's
+// actors get matching net names. An empty LevelName generates a unique one. Null if the map doesn't exist.
+ULevelStreamingDynamic* UntestLoadMapInstance(UWorld* World, const FString& MapPackageName, const FString& LevelName);
+
+// Resumes once a level from UntestLoadMapInstance() has loaded and been made visible. False if it failed to load.
+Squid::Task<bool> UntestWaitForMapInstance(UWorld* World, ULevelStreamingDynamic* StreamingLevel);
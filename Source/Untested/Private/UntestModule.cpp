@@ -1,9 +1,22 @@
 #include "UntestModule.h"
 #include "Untest.h"
 #include "UI/UntestUI.h"
-
-#include "Modules/ModuleManager.h"
+#include "UntestGarbageCollector.h"
+#include "UntestMapPreloader.h"
+#include "UntestWorldPool.h"
+
+#include "Algo/Find.h"
+#include "Algo/StableSort.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Crc.h"
 #include "Misc/FileHelper.h"
+#include "Modules/ModuleManager.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#elif PLATFORM_UNIX || PLATFORM_MAC
+#include <time.h>
+#endif
 
 const TCHAR* UntestResultStr(EUntestResult Result)
 {
@@ -20,6 +33,166 @@ const TCHAR* UntestResultStr(EUntestResult Result)
 	return TEXT("<UNKNOWN>");
 }
 
+const TCHAR* UntestTimeoutClockStr(EUntestTimeoutClock Clock)
+{
+	switch (Clock)
+	{
+		case EUntestTimeoutClock::Wall:
+			return TEXT("wall");
+		case EUntestTimeoutClock::ThreadCpu:
+			return TEXT("cpu");
+	}
+	ensureMsgf(false, TEXT("Unhandled case %u"), static_cast<uint32>(Clock));
+	return TEXT("<UNKNOWN>");
+}
+
+const TCHAR* UntestGCPolicyStr(EUntestGCPolicy Policy)
+{
+	switch (Policy)
+	{
+		case EUntestGCPolicy::EveryTest:
+			return TEXT("EveryTest");
+		case EUntestGCPolicy::EveryNTests:
+			return TEXT("EveryNTests");
+		case EUntestGCPolicy::MemoryThreshold:
+			return TEXT("MemoryThreshold");
+		case EUntestGCPolicy::Incremental:
+			return TEXT("Incremental");
+	}
+	ensureMsgf(false, TEXT("Unhandled case %u"), static_cast<uint32>(Policy));
+	return TEXT("<UNKNOWN>");
+}
+
+const TCHAR* UntestReplicationSystemStr(EUntestReplicationSystem System)
+{
+	switch (System)
+	{
+		case EUntestReplicationSystem::Default:
+			return TEXT("Default");
+		case EUntestReplicationSystem::Generic:
+			return TEXT("Generic");
+		case EUntestReplicationSystem::Iris:
+			return TEXT("Iris");
+	}
+	ensureMsgf(false, TEXT("Unhandled case %u"), static_cast<uint32>(System));
+	return TEXT("<UNKNOWN>");
+}
+
+const TCHAR* UntestWorldProfileStr(EUntestWorldProfile Profile)
+{
+	switch (Profile)
+	{
+		case EUntestWorldProfile::Bare:
+			return TEXT("Bare");
+		case EUntestWorldProfile::Gameplay:
+			return TEXT("Gameplay");
+		case EUntestWorldProfile::Full:
+			return TEXT("Full");
+	}
+	ensureMsgf(false, TEXT("Unhandled case %u"), static_cast<uint32>(Profile));
+	return TEXT("<UNKNOWN>");
+}
+
+static double GetRatio(double Iris, double Generic)
+{
+	return (Iris > 0.0 && Generic > 0.0) ? Iris / Generic : 0.0;
+}
+
+double FUntestReplicationComparison::GetOutBytesRatio() const
+{
+	return GetRatio(Iris->NetStats.GetOutBytesPerSecond(), Generic->NetStats.GetOutBytesPerSecond());
+}
+
+double FUntestReplicationComparison::GetReplicateMsRatio() const
+{
+	return GetRatio(Iris->NetStats.GetAvgReplicateActorsMsPerFrame(), Generic->NetStats.GetAvgReplicateActorsMsPerFrame());
+}
+
+TArray<FUntestReplicationComparison> UntestCompareReplicationSystems(TArrayView<const FUntestResults> AllResults)
+{
+	TArray<FUntestReplicationComparison> Comparisons;
+	for (const FUntestResults& IrisResults : AllResults)
+	{
+		if (IrisResults.ReplicationSystem != EUntestReplicationSystem::Iris)
+		{
+			continue;
+		}
+
+		const FString TestName = IrisResults.TestName.ToFull();
+		const FUntestResults* GenericResults = AllResults.FindByPredicate([&TestName](const FUntestResults& Results)
+			{
+				return Results.ReplicationSystem == EUntestReplicationSystem::Generic && Results.TestName.ToFull() == TestName;
+			});
+		if (GenericResults)
+		{
+			Comparisons.Emplace(FUntestReplicationComparison{ GenericResults, &IrisResults });
+		}
+	}
+	return Comparisons;
+}
+
+// Read by the engine when a NetDriver is created, so switching it between tests switches the replication system of
+// every server and client created afterwards
+static IConsoleVariable* FindUseIrisReplicationCVar()
+{
+	return IConsoleManager::Get().FindConsoleVariable(TEXT("net.Iris.UseIrisReplication"));
+}
+
+#if PLATFORM_WINDOWS
+// QueryThreadCycleTime() counts at a fixed rate that Windows doesn't report, so it's measured once by spinning the
+// calling thread. The best of a few tries is kept, since being descheduled while spinning only lowers the rate.
+static double GetThreadCyclesPerMs()
+{
+	static const double CyclesPerMs = []()
+	{
+		double BestCyclesPerMs = 0.0;
+		for (int32 Try = 0; Try < 3; ++Try)
+		{
+			ULONG64 CyclesBegin = 0;
+			ULONG64 CyclesEnd = 0;
+			::QueryThreadCycleTime(::GetCurrentThread(), &CyclesBegin);
+			const double WallBegin = FPlatformTime::Seconds();
+			double WallEnd = WallBegin;
+			while (WallEnd - WallBegin < 0.005)
+			{
+				WallEnd = FPlatformTime::Seconds();
+			}
+			::QueryThreadCycleTime(::GetCurrentThread(), &CyclesEnd);
+
+			BestCyclesPerMs = FMath::Max(BestCyclesPerMs, static_cast<double>(CyclesEnd - CyclesBegin) / ((WallEnd - WallBegin) * 1000.0));
+		}
+		return BestCyclesPerMs;
+	}();
+	return CyclesPerMs;
+}
+#endif
+
+// CPU time consumed by the calling thread. Unlike wall time, this doesn't advance while the thread is
+// descheduled or while a test is waiting for other tests to run.
+static double GetThreadCpuTimeMs()
+{
+#if PLATFORM_WINDOWS
+	// GetThreadTimes() only advances once per scheduler tick (~15.6ms), far too coarse for sub-millisecond unit tests,
+	// while the thread's cycle count is exact
+	const double CyclesPerMs = GetThreadCyclesPerMs();
+	ULONG64 Cycles = 0;
+	if (CyclesPerMs > 0.0 && ::QueryThreadCycleTime(::GetCurrentThread(), &Cycles))
+	{
+		return static_cast<double>(Cycles) / CyclesPerMs;
+	}
+	return 0.0;
+#elif PLATFORM_UNIX || PLATFORM_MAC
+	struct timespec Time;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &Time) == 0)
+	{
+		return static_cast<double>(Time.tv_sec) * 1000.0 + static_cast<double>(Time.tv_nsec) / 1000000.0;
+	}
+	return 0.0;
+#else
+	return FPlatformTime::Seconds() * 1000.0; // no per-thread clock available, fall back to wall time
+#endif
+}
+
 FUntestSearchFilter::FUntestSearchFilter()
 	: Types(EUntestTypeFlags::All)
 {
@@ -27,7 +200,18 @@ FUntestSearchFilter::FUntestSearchFilter()
 
 const FName NAME_Module = TEXT("Untested");
 
+// Approximate cost of the calibration workload on the desktop workstations the default timeouts were tuned on.
+static constexpr double CalibrationReferenceMs = 2.5;
+
+// Keeps a very slow or heavily loaded machine from effectively disabling timeouts.
+static constexpr float MaxCalibratedTimeoutScale = 20.0f;
+
+// Queued tests whose maps are loaded in the background while earlier tests run. Loaded maps stay in memory until the
+// end of the run, so this is kept small.
+static constexpr int32 MapPreloadLookahead = 4;
+
 TMap<FString, const FUntestFixtureFactory*>* FUntestModule::TestFactories = nullptr;
+TMap<FString, const FUntestSuiteFactory*>* FUntestModule::SuiteFactories = nullptr;
 
 FUntestModule& FUntestModule::Get()
 {
@@ -53,8 +237,18 @@ bool FUntestModule::Tick(float DeltaTime)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestModule::Tick);
 
-	if (RunningTests.Num() == 0 && QueuedTests.Num() > 0)
+	FUntestGarbageCollector& GarbageCollector = FUntestGarbageCollector::Get();
+	GarbageCollector.Tick();
+
+	if (QueuedTests.Num() > 0 && CanStartNextTest())
 	{
+		// Collect garbage from the previous tests before starting new ones so it doesn't count against their timeouts
+		if (RunningTests.Num() == 0)
+		{
+			GarbageCollector.CollectIfNeeded();
+			ReportLeaks();
+		}
+
 		FTestFactoryMap& Factories = GetTestFactories();
 
 		bool bCanQueueNextTest = true;
@@ -84,8 +278,28 @@ bool FUntestModule::Tick(float DeltaTime)
 
 				TSharedPtr<FUntestContext> TestContext = MakeShared<FUntestContext>();
 				TestContext->TestName = Factory->GetName();
+				TestContext->TestType = Factory->GetType();
 				TestContext->TaskManager = MakeUnique<Squid::TaskManager>();
-				TestContext->TimeoutMs = Opts.TimeoutMs;
+				TestContext->TimeoutMs = Opts.TimeoutMs * TimeoutScale;
+				TestContext->MapPackageName = Opts.MapPackageName;
+				const FString SuiteName = TestContext->TestName.ToSuite();
+				if (const FUntestSuiteFactory** SuiteFactory = GetSuiteFactories().Find(SuiteName))
+				{
+					TSharedPtr<FUntestSuite>& Suite = ActiveSuites.FindOrAdd(SuiteName);
+					if (Suite.IsValid() == false)
+					{
+						Suite = (*SuiteFactory)->New();
+					}
+					TestContext->Suite = Suite;
+				}
+				if (TestContext->TestType == EUntestTypeFlags::World && RunningTests.Num() > 0)
+				{
+					TestContext->RunAfterTask = RunningTests.Last()->GetContext().Task;
+				}
+				if (TestContext->TestType == EUntestTypeFlags::ClientServer)
+				{
+					TestContext->ReplicationSystem = ReplicationSystem;
+				}
 				// NOTE: TestContext->TimestampBegin is set in RunTest() to get a more accurate time since the
 				// coroutine always yields at first
 
@@ -95,11 +309,13 @@ bool FUntestModule::Tick(float DeltaTime)
 				RunningTests.Emplace(Fixture);
 
 				// TODO run pure tests on a worker thread if needed
-				bCanQueueNextTest = Opts.IsSet(EUntestFlags::Pure);
+				bCanQueueNextTest = Opts.IsSet(EUntestFlags::Pure) || (QueuedTests.Num() > 0 && CanStartNextTest());
 			}
 		}
 	}
 
+	PreloadQueuedMaps();
+
 	// Calling update _after_ new tasks have been queued gives them a chance to be finished this frame if they don't
 	// need to update
 	const double TimesliceBudgetMs = 8.0;
@@ -108,28 +324,59 @@ bool FUntestModule::Tick(float DeltaTime)
 	{
 		FUntestContext& Context = Fixture->GetContext();
 
+		// A pipelined test is still setting up, or waiting, behind the test ahead of it
+		const bool bIsSettingUpAhead = Context.RunAfterTask.IsDone() == false;
+		const bool bIsRunning = bIsSettingUpAhead == false && Context.Task.IsDone() == false;
+		const double UpdateBegin = FPlatformTime::Seconds();
+
 		{
 			FString FullTestName = Context.GetName().ToFull();
 			TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(*FullTestName);
 
+			const double CpuBeginMs = GetThreadCpuTimeMs();
 			Context.TaskManager->Update();
+			Context.CpuTimeMs += GetThreadCpuTimeMs() - CpuBeginMs;
 		}
 
 		const double Now = FPlatformTime::Seconds();
 
-		const double TestElapsedMs = (Now - Context.TimestampBegin) * 1000.0;
-		if (RunOpts.bNoTimeouts == false && TestElapsedMs > Context.TimeoutMs)
+		// The setup runs in the same frames as the test it's pipelined behind, so neither counts the other's update
+		// towards its duration or timeout. Time spent waiting to run is already left out of the setup's duration.
+		if (bIsSettingUpAhead || bIsRunning)
+		{
+			for (TSharedPtr<FUntestFixture>& OtherFixture : RunningTests)
+			{
+				FUntestContext& OtherContext = OtherFixture->GetContext();
+				if (&OtherContext == &Context)
+				{
+					continue;
+				}
+
+				const bool bOtherIsSettingUpAhead = OtherContext.RunAfterTask.IsDone() == false;
+				const bool bOtherIsRunning = bOtherIsSettingUpAhead == false && OtherContext.Task.IsDone() == false;
+				const bool bAdjust = bIsSettingUpAhead ? bOtherIsRunning : (bOtherIsSettingUpAhead && OtherContext.bWaitingToRun == false);
+				if (bAdjust)
+				{
+					OtherContext.TimestampBegin += Now - UpdateBegin;
+				}
+			}
+		}
+
+		const double TestElapsedMs = (RunOpts.TimeoutClock == EUntestTimeoutClock::ThreadCpu) ? Context.CpuTimeMs : (Now - Context.TimestampBegin) * 1000.0;
+		if (RunOpts.bNoTimeouts == false && Context.bWaitingToRun == false && TestElapsedMs > Context.TimeoutMs)
 		{
 			Context.TimestampEnd = Now;
 
+			const TCHAR* ClockStr = UntestTimeoutClockStr(RunOpts.TimeoutClock);
+
 			FString Error;
 			if (Context.Task.IsDone())
 			{
-				Error = FString::Printf(TEXT("Test finished, but overran timeout limit: %.2fms elapsed / %.2fms max"), TestElapsedMs, Context.TimeoutMs);
+				Error = FString::Printf(TEXT("Test finished, but overran timeout limit: %.2fms %s elapsed / %.2fms max (timeout scale %.2f)"), TestElapsedMs, ClockStr, Context.TimeoutMs, TimeoutScale);
 			}
 			else
 			{
-				Error = FString::Printf(TEXT("Timed out at: %.2fms elapsed / %.2fms max"), TestElapsedMs, Context.TimeoutMs);
+				Error = FString::Printf(TEXT("Timed out at: %.2fms %s elapsed / %.2fms max (timeout scale %.2f)"), TestElapsedMs, ClockStr, Context.TimeoutMs, TimeoutScale);
 				Context.Task.Kill();
 				// TODO handle graceful teardown by moving the task stuff into StoppingTests
 			}
@@ -151,12 +398,24 @@ bool FUntestModule::Tick(float DeltaTime)
 			FUntestResults Results;
 			Results.TestName = MoveTemp(Context.TestName);
 			Results.DurationMs = (Context.TimestampEnd - Context.TimestampBegin) * 1000.0;
+			Results.CpuDurationMs = Context.CpuTimeMs;
 			Results.Result = Context.Errors.IsEmpty() ? EUntestResult::Success : EUntestResult::Fail;
 			Results.Errors = MoveTemp(Context.Errors);
+			Results.Metrics = MoveTemp(Context.Metrics);
+			Results.NetStats = Context.NetStats;
+			Results.ReplicationSystem = Context.ReplicationSystem;
+
+			// Without server replication time the IrisVsGeneric ratio would silently read 0
+			if (Results.ReplicationSystem != EUntestReplicationSystem::Default && Results.NetStats.IsValid() && Results.NetStats.ReplicateActorsMs <= 0.0)
+			{
+				UE_LOG(LogUntest, Warning, TEXT("%s [%s]: the server NetDriver reported no replication time, so it can't be compared. Only the default loopback NetDriver records it."),
+					*Results.TestName.ToFull(), UntestReplicationSystemStr(Results.ReplicationSystem));
+			}
 
 			TestResults.Emplace(MoveTemp(Results));
 
 			RunOpts.OnTestComplete.ExecuteIfBound(TestResults.Last());
+			GarbageCollector.OnTestFinished();
 
 			RunningTests.RemoveAtSwap(i, EAllowShrinking::No);
 		}
@@ -169,7 +428,11 @@ bool FUntestModule::Tick(float DeltaTime)
 	for (int i = 0; i < StoppingTests.Num();)
 	{
 		FUntestContext& Context = StoppingTests[i]->GetContext();
+
+		const double CpuBeginMs = GetThreadCpuTimeMs();
 		Context.TaskManager->Update();
+		Context.CpuTimeMs += GetThreadCpuTimeMs() - CpuBeginMs;
+
 		if (Context.Task.IsDone())
 		{
 			const double Now = FPlatformTime::Seconds();
@@ -177,12 +440,17 @@ bool FUntestModule::Tick(float DeltaTime)
 			FUntestResults Results;
 			Results.TestName = MoveTemp(Context.TestName);
 			Results.DurationMs = (Now - Context.TimestampBegin) * 1000.0;
+			Results.CpuDurationMs = Context.CpuTimeMs;
 			Results.Result = Context.Errors.IsEmpty() ? EUntestResult::Skipped : EUntestResult::Fail;
 			Results.Errors = MoveTemp(Context.Errors);
+			Results.Metrics = MoveTemp(Context.Metrics);
+			Results.NetStats = Context.NetStats;
+			Results.ReplicationSystem = Context.ReplicationSystem;
 
 			TestResults.Emplace(MoveTemp(Results));
 
 			RunOpts.OnTestComplete.ExecuteIfBound(TestResults.Last());
+			GarbageCollector.OnTestFinished();
 
 			StoppingTests.RemoveAtSwap(i, EAllowShrinking::No);
 		}
@@ -192,8 +460,31 @@ bool FUntestModule::Tick(float DeltaTime)
 		}
 	}
 
+	TeardownFinishedSuites();
+
 	if (RunningTests.IsEmpty() && QueuedTests.IsEmpty() && StoppingTests.IsEmpty())
 	{
+		FUntestWorldPool::Get().Empty();
+		FUntestClientServerPool::Get().Empty();
+		FUntestMapPreloader::Get().Empty();
+
+		// The pools are empty, so every server and client of the second pass is created with Iris. The first pass's
+		// worlds and packages have the same names as the ones the second pass creates, so they must be collected first.
+		if (IrisPassTests.Num() > 0)
+		{
+			GarbageCollector.Finish();
+			ReportLeaks();
+
+			SetReplicationSystem(EUntestReplicationSystem::Iris);
+			QueuedTests = MoveTemp(IrisPassTests);
+			Algo::Reverse(QueuedTests);
+			return true;
+		}
+		SetReplicationSystem(EUntestReplicationSystem::Default);
+
+		GarbageCollector.Finish();
+		ReportLeaks();
+
 		RunOpts.OnAllTestsComplete.ExecuteIfBound(TestResults);
 
 		return false; // unschedule tick
@@ -219,6 +510,19 @@ void FUntestModule::UnregisterFixture(const FUntestFixtureFactory& Factory)
 	Factories.Remove(Factory.GetName().ToFull());
 }
 
+void FUntestModule::RegisterSuite(const FUntestSuiteFactory& Factory)
+{
+	FSuiteFactoryMap& Factories = GetSuiteFactories();
+	checkf(Factories.Contains(Factory.GetName()) == false,
+		TEXT("Another suite has been registered for %s. Each Module.Category can only have one."), *Factory.GetName());
+	Factories.Emplace(Factory.GetName(), &Factory);
+}
+
+void FUntestModule::UnregisterSuite(const FUntestSuiteFactory& Factory)
+{
+	GetSuiteFactories().Remove(Factory.GetName());
+}
+
 TArray<FUntestInfo> FUntestModule::FindTests(const FUntestSearchFilter& Filter)
 {
 	FTestFactoryMap& Factories = GetTestFactories();
@@ -246,6 +550,24 @@ TArray<FUntestInfo> FUntestModule::FindTests(const FUntestSearchFilter& Filter)
 	return Tests;
 }
 
+TSharedPtr<FUntestFixture> FUntestModule::NewFixture(const FString& FullTestName, EUntestReplicationSystem System) const
+{
+	const FUntestFixtureFactory* const* FactoryPtr = GetTestFactories().Find(FullTestName);
+	if (FactoryPtr == nullptr)
+	{
+		return nullptr;
+	}
+
+	const FUntestFixtureFactory* Factory = *FactoryPtr;
+	TSharedPtr<FUntestContext> TestContext = MakeShared<FUntestContext>();
+	TestContext->TestName = Factory->GetName();
+	TestContext->TestType = Factory->GetType();
+	TestContext->TimeoutMs = Factory->GetOpts().TimeoutMs;
+	TestContext->MapPackageName = Factory->GetOpts().MapPackageName;
+	TestContext->ReplicationSystem = System;
+	return Factory->New(TestContext);
+}
+
 bool FUntestModule::QueueTests(TArrayView<const FString> TestNames, const FUntestRunOpts& Opts)
 {
 	// We only run one set of tests at a time - this prevents multiple systems from
@@ -253,10 +575,43 @@ bool FUntestModule::QueueTests(TArrayView<const FString> TestNames, const FUntes
 	if (HasRunningTests() == false)
 	{
 		RunOpts = Opts;
+		TimeoutScale = (Opts.TimeoutScale > 0.0f) ? Opts.TimeoutScale : CalibrateTimeoutScale();
+		UE_LOG(LogUntest, Display, TEXT("Using timeout scale %.2f%s"), TimeoutScale, (Opts.TimeoutScale > 0.0f) ? TEXT(" (override)") : TEXT(" (calibrated)"));
+		GetThreadCpuTimeMs(); // Calibrates the thread clock where needed, so it doesn't happen while timing the first test
+
+		FUntestWorldPool::Get().SetEnabled(Opts.bReuseWorlds);
+		FUntestClientServerPool::Get().SetEnabled(Opts.bReuseWorlds);
+		FUntestClientServerPool::Get().SetMaxFreePairsPerKey(Opts.MaxConcurrentNetTests);
+		FUntestGarbageCollector::Get().Begin(Opts);
+
 		QueuedTests.Append(TestNames);
+		GroupBySuite(QueuedTests);
 		Algo::Reverse(QueuedTests);
 		TestResults.Reset();
 
+		IrisPassTests.Reset();
+		if (Opts.bCompareReplicationSystems)
+		{
+			if (FindUseIrisReplicationCVar())
+			{
+				FTestFactoryMap& Factories = GetTestFactories();
+				for (const FString& TestName : TestNames)
+				{
+					const FUntestFixtureFactory** Factory = Factories.Find(TestName);
+					if (Factory && (*Factory)->GetType() == EUntestTypeFlags::ClientServer)
+					{
+						IrisPassTests.Emplace(TestName);
+					}
+				}
+				GroupBySuite(IrisPassTests);
+				SetReplicationSystem(EUntestReplicationSystem::Generic);
+			}
+			else
+			{
+				UE_LOG(LogUntest, Error, TEXT("Can't compare replication systems: net.Iris.UseIrisReplication doesn't exist, so this engine was built without Iris"));
+			}
+		}
+
 		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FUntestModule::Tick));
 		return true;
 	}
@@ -277,6 +632,7 @@ void FUntestModule::StopTests()
 	}
 
 	QueuedTests.Reset();
+	IrisPassTests.Reset();
 
 	for (TSharedPtr<FUntestFixture>& Fixture : RunningTests)
 	{
@@ -299,6 +655,94 @@ TArrayView<const FUntestResults> FUntestModule::GetResults() const
 	return TestResults;
 }
 
+float FUntestModule::CalibrateTimeoutScale()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestModule::CalibrateTimeoutScale);
+
+	// Mix of integer hashing and floating point math so the result isn't dominated by a single execution unit
+	TArray<uint32> Buffer;
+	Buffer.SetNumUninitialized(16 * 1024);
+	for (int32 i = 0; i < Buffer.Num(); ++i)
+	{
+		Buffer[i] = static_cast<uint32>(i) * 2654435761u;
+	}
+
+	// Take the fastest of several runs so a single context switch doesn't skew the result
+	const int32 NumRuns = 5;
+	double BestMs = TNumericLimits<double>::Max();
+	for (int32 Run = 0; Run < NumRuns; ++Run)
+	{
+		const double TimestampBegin = FPlatformTime::Seconds();
+
+		uint32 Crc = 0;
+		double Accumulator = 0.0;
+		for (int32 Iteration = 0; Iteration < 64; ++Iteration)
+		{
+			Crc = FCrc::MemCrc32(Buffer.GetData(), Buffer.Num() * sizeof(uint32), Crc);
+			for (int32 i = 0; i < 4096; ++i)
+			{
+				Accumulator += FMath::Sqrt(static_cast<double>(i + (Crc & 0x7)));
+			}
+		}
+
+		const double ElapsedMs = (FPlatformTime::Seconds() - TimestampBegin) * 1000.0;
+
+		// Prevents the optimizer from discarding the workload
+		volatile double Sink = Accumulator + Crc;
+		(void)Sink;
+
+		BestMs = FMath::Min(BestMs, ElapsedMs);
+	}
+
+	const float Scale = static_cast<float>(BestMs / CalibrationReferenceMs);
+	return FMath::Clamp(Scale, 1.0f, MaxCalibratedTimeoutScale);
+}
+
+static void AppendNetStatsProperties(TStringBuilder<512>& Xml, const FUntestNetStats& Stats)
+{
+	auto AppendProperty = [&Xml](const TCHAR* Name, double Value)
+	{
+		Xml.Appendf(TEXT("\t\t\t\t\t<property name=\"Net.%s\" value=\"%.4f\"/>\n"), Name, Value);
+	};
+
+	AppendProperty(TEXT("Frames"), Stats.Frames);
+	AppendProperty(TEXT("OutBytes"), Stats.OutBytes);
+	AppendProperty(TEXT("InBytes"), Stats.InBytes);
+	AppendProperty(TEXT("OutBytesPerSec"), Stats.GetOutBytesPerSecond());
+	AppendProperty(TEXT("InBytesPerSec"), Stats.GetInBytesPerSecond());
+	AppendProperty(TEXT("OutPackets"), Stats.OutPackets);
+	AppendProperty(TEXT("InPackets"), Stats.InPackets);
+	AppendProperty(TEXT("OutBunches"), Stats.OutBunches);
+	AppendProperty(TEXT("InBunches"), Stats.InBunches);
+	AppendProperty(TEXT("OutRPCs"), Stats.OutRPCs);
+	AppendProperty(TEXT("InRPCs"), Stats.InRPCs);
+	AppendProperty(TEXT("ReplicatedActorsPerFrame.Avg"), Stats.GetAvgReplicatedActorsPerFrame());
+	AppendProperty(TEXT("ReplicatedActorsPerFrame.Max"), Stats.MaxReplicatedActorsPerFrame);
+	AppendProperty(TEXT("ReplicateActorsMsPerFrame.Avg"), Stats.GetAvgReplicateActorsMsPerFrame());
+	AppendProperty(TEXT("ReplicateActorsMsPerFrame.Max"), Stats.MaxReplicateActorsMsPerFrame);
+	if (Stats.RttSamples > 0)
+	{
+		AppendProperty(TEXT("RttMs.Avg"), Stats.AvgRttMs);
+		AppendProperty(TEXT("RttMs.Max"), Stats.MaxRttMs);
+	}
+}
+
+// Added to the Iris run of a compared test, so the difference to the generic run can be read off a single testcase
+static void AppendReplicationComparisonProperties(TStringBuilder<512>& Xml, const FUntestReplicationComparison& Comparison)
+{
+	auto AppendProperty = [&Xml](const TCHAR* Name, double Value)
+	{
+		Xml.Appendf(TEXT("\t\t\t\t\t<property name=\"IrisVsGeneric.%s\" value=\"%.4f\"/>\n"), Name, Value);
+	};
+
+	AppendProperty(TEXT("OutBytesPerSec.Generic"), Comparison.Generic->NetStats.GetOutBytesPerSecond());
+	AppendProperty(TEXT("OutBytesPerSec.Ratio"), Comparison.GetOutBytesRatio());
+	AppendProperty(TEXT("ReplicateActorsMsPerFrame.Generic"), Comparison.Generic->NetStats.GetAvgReplicateActorsMsPerFrame());
+	AppendProperty(TEXT("ReplicateActorsMsPerFrame.Ratio"), Comparison.GetReplicateMsRatio());
+	Xml.Appendf(TEXT("\t\t\t\t\t<property name=\"IrisVsGeneric.GenericResult\" value=\"%s\"/>\n"), UntestResultStr(Comparison.Generic->Result));
+	Xml.Appendf(TEXT("\t\t\t\t\t<property name=\"IrisVsGeneric.SameResult\" value=\"%s\"/>\n"), Comparison.HaveSameResult() ? TEXT("true") : TEXT("false"));
+}
+
 bool FUntestModule::WriteTestReport(const TCHAR* ReportPath) const
 {
 	struct FTestStats
@@ -353,6 +797,8 @@ bool FUntestModule::WriteTestReport(const TCHAR* ReportPath) const
 		}
 	}
 
+	const TArray<FUntestReplicationComparison> Comparisons = UntestCompareReplicationSystems(TestResults);
+
 	TStringBuilder<512> Xml;
 	Xml.Append(TEXT("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"));
 	Xml.Appendf(TEXT("<testsuites tests=\"%d\" failures=\"%d\" time=\"%.2f\">\n"),
@@ -362,6 +808,12 @@ bool FUntestModule::WriteTestReport(const TCHAR* ReportPath) const
 		const FTestStats& ModuleStats = ModuleResults.Value.Stats;
 		Xml.Appendf(TEXT("\t<testsuite name=\"%s\" tests=\"%d\" failures=\"%d\" time=\"%.2f\">\n"),
 			*ModuleResults.Key, ModuleStats.NumTests, ModuleStats.NumFailed, ModuleStats.TotalDurationSecs);
+		Xml.Append(TEXT("\t\t<properties>\n"));
+		Xml.Appendf(TEXT("\t\t\t<property name=\"TimeoutScale\" value=\"%.2f\"/>\n"), TimeoutScale);
+		Xml.Appendf(TEXT("\t\t\t<property name=\"TimeoutClock\" value=\"%s\"/>\n"), UntestTimeoutClockStr(RunOpts.TimeoutClock));
+		Xml.Appendf(TEXT("\t\t\t<property name=\"GCPolicy\" value=\"%s\"/>\n"), UntestGCPolicyStr(RunOpts.GCPolicy));
+		Xml.Appendf(TEXT("\t\t\t<property name=\"CompareReplicationSystems\" value=\"%s\"/>\n"), RunOpts.bCompareReplicationSystems ? TEXT("true") : TEXT("false"));
+		Xml.Append(TEXT("\t\t</properties>\n"));
 		for (auto&& CategoryResults : ModuleResults.Value.Categories)
 		{
 			const FTestStats& CategoryStats = CategoryResults.Value.Stats;
@@ -369,13 +821,35 @@ bool FUntestModule::WriteTestReport(const TCHAR* ReportPath) const
 				*CategoryResults.Key, CategoryStats.NumTests, CategoryStats.NumFailed, CategoryStats.TotalDurationSecs);
 			CategoryResults.Value.Results.Sort([](const FUntestResults& A, const FUntestResults& B)
 				{
-					return A.TestName.Test < B.TestName.Test;
+					return (A.TestName.Test != B.TestName.Test) ? (A.TestName.Test < B.TestName.Test) : (A.ReplicationSystem < B.ReplicationSystem);
 				});
 
 			for (const FUntestResults* Test : CategoryResults.Value.Results)
 			{
+				// Both runs of a compared test need their own name, or tools reading the report merge them
+				FString TestCaseName = Test->TestName.Test;
+				if (Test->ReplicationSystem != EUntestReplicationSystem::Default)
+				{
+					TestCaseName += FString::Printf(TEXT(" [%s]"), UntestReplicationSystemStr(Test->ReplicationSystem));
+				}
+
 				Xml.Appendf(TEXT("\t\t\t<testcase name=\"%s\" classname=\"%s\" time=\"%.2f\">\n"),
-					*Test->TestName.Test, *Test->TestName.ToFull(), Test->DurationMs / 1000.0);
+					*TestCaseName, *Test->TestName.ToFull(), Test->DurationMs / 1000.0);
+				Xml.Append(TEXT("\t\t\t\t<properties>\n"));
+				Xml.Appendf(TEXT("\t\t\t\t\t<property name=\"CpuTimeMs\" value=\"%.3f\"/>\n"), Test->CpuDurationMs);
+				for (const FUntestMetric& Metric : Test->Metrics)
+				{
+					Xml.Appendf(TEXT("\t\t\t\t\t<property name=\"%s\" value=\"%.4f\"/>\n"), *Metric.Name, Metric.Value);
+				}
+				if (Test->NetStats.IsValid())
+				{
+					AppendNetStatsProperties(Xml, Test->NetStats);
+				}
+				if (const FUntestReplicationComparison* Comparison = Algo::FindBy(Comparisons, Test, &FUntestReplicationComparison::Iris))
+				{
+					AppendReplicationComparisonProperties(Xml, *Comparison);
+				}
+				Xml.Append(TEXT("\t\t\t\t</properties>\n"));
 				if (Test->Result == EUntestResult::Skipped)
 				{
 					Xml.Append(TEXT("\t\t\t\t<skipped/>\n"));
@@ -416,12 +890,275 @@ FUntestModule::FTestFactoryMap& FUntestModule::GetTestFactories()
 	return *TestFactories;
 }
 
+FUntestModule::FSuiteFactoryMap& FUntestModule::GetSuiteFactories()
+{
+	if (SuiteFactories == nullptr)
+	{
+		SuiteFactories = new FSuiteFactoryMap();
+	}
+	return *SuiteFactories;
+}
+
+static FString GetSuiteName(const FString& FullTestName)
+{
+	FString SuiteName;
+	FullTestName.Split(TEXT("."), &SuiteName, nullptr, ESearchCase::CaseSensitive, ESearchDir::FromEnd);
+	return SuiteName;
+}
+
+// Runs each suite's tests back to back so its shared state is only set up once. Suites keep the order their first test
+// was queued in, and tests keep their order within a suite.
+void FUntestModule::GroupBySuite(TArray<FString>& TestNames)
+{
+	TMap<FString, int32> SuiteOrder;
+	for (const FString& TestName : TestNames)
+	{
+		const FString SuiteName = GetSuiteName(TestName);
+		if (SuiteOrder.Contains(SuiteName) == false)
+		{
+			SuiteOrder.Add(SuiteName, SuiteOrder.Num());
+		}
+	}
+
+	Algo::StableSortBy(TestNames, [&SuiteOrder](const FString& TestName)
+		{
+			return SuiteOrder.FindChecked(GetSuiteName(TestName));
+		});
+}
+
+UntestTask FUntestModule::SetupSuite(FUntestContext& Context)
+{
+	FUntestSuite& Suite = *Context.Suite;
+	if (Suite.State == FUntestSuite::EState::New)
+	{
+		Suite.State = FUntestSuite::EState::SettingUp;
+		Suite.SetupTestName = Context.GetName().ToFull();
+
+		// The test's own timeout is suspended meanwhile, so the suite's setup needs its own for a stuck Setup() to fail
+		// instead of hanging the run
+		const double TimeoutMs = (Suite.GetSetupTimeoutMs() > 0.0f) ? Suite.GetSetupTimeoutMs() * TimeoutScale : Context.TimeoutMs;
+		const double SetupBegin = FPlatformTime::Seconds();
+		double ElapsedMs = 0.0;
+		UntestTask SetupTask = Suite.Setup(Context);
+		co_await Squid::WaitUntil([this, &SetupTask, &ElapsedMs, SetupBegin, TimeoutMs]()
+			{
+				SetupTask.Resume();
+				ElapsedMs = (FPlatformTime::Seconds() - SetupBegin) * 1000.0;
+				return SetupTask.IsDone() || (RunOpts.bNoTimeouts == false && ElapsedMs > TimeoutMs);
+			});
+		Context.AddMetric(TEXT("SuiteSetupMs"), ElapsedMs);
+
+		if (SetupTask.IsDone() == false)
+		{
+			SetupTask.Kill();
+			Context.AddError(FString::Printf(TEXT("Suite setup timed out at: %.2fms elapsed / %.2fms max (timeout scale %.2f)"), ElapsedMs, TimeoutMs, TimeoutScale));
+		}
+
+		Suite.State = Context.Errors.IsEmpty() ? FUntestSuite::EState::Ready : FUntestSuite::EState::Failed;
+		co_return;
+	}
+
+	// Tests that run alongside the one setting the suite up, e.g. batched Pure tests, wait for it to finish
+	co_await Squid::WaitUntil([&Suite]()
+		{
+			return Suite.State != FUntestSuite::EState::SettingUp;
+		});
+
+	if (Suite.State == FUntestSuite::EState::Failed)
+	{
+		Context.AddError(FString::Printf(TEXT("Suite setup failed in %s"), *Suite.SetupTestName));
+	}
+}
+
+// Queued tests are grouped by suite, so a suite is done once none of its tests are running and the next queued test
+// belongs to another suite
+void FUntestModule::TeardownFinishedSuites()
+{
+	if (ActiveSuites.IsEmpty())
+	{
+		return;
+	}
+
+	const FString NextSuiteName = (QueuedTests.Num() > 0) ? GetSuiteName(QueuedTests.Last()) : FString();
+	for (auto It = ActiveSuites.CreateIterator(); It; ++It)
+	{
+		if (It.Key() == NextSuiteName)
+		{
+			continue;
+		}
+
+		auto IsInSuite = [&It](const TSharedPtr<FUntestFixture>& Fixture)
+		{
+			return Fixture->GetContext().Suite == It.Value();
+		};
+		if (RunningTests.ContainsByPredicate(IsInSuite) || StoppingTests.ContainsByPredicate(IsInSuite))
+		{
+			continue;
+		}
+
+		It.Value()->Teardown();
+		It.RemoveCurrent();
+	}
+}
+
+// ClientServer tests listen on their own port and only remove their own PIE package names, so several of them can run
+// alongside each other. Everything else runs alone, apart from batches of Pure tests.
+bool FUntestModule::CanStartNextTest() const
+{
+	if (RunningTests.Num() == 0)
+	{
+		return true;
+	}
+
+	if (CanPipelineNextTest())
+	{
+		return true;
+	}
+
+	if (RunningTests.Num() >= RunOpts.MaxConcurrentNetTests)
+	{
+		return false;
+	}
+
+	const FUntestFixtureFactory* const* NextFactory = GetTestFactories().Find(QueuedTests.Last());
+	if (NextFactory == nullptr || (*NextFactory)->GetType() != EUntestTypeFlags::ClientServer)
+	{
+		return false;
+	}
+
+	for (const TSharedPtr<FUntestFixture>& Fixture : RunningTests)
+	{
+		if (Fixture->GetContext().TestType != EUntestTypeFlags::ClientServer)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Most of a World test's time goes to setting up its world, so the next World test sets up while the one ahead of it
+// runs, then waits for it to finish before running itself. Only one test is set up ahead, and only while no garbage
+// collection is due, since collections only happen once nothing is running.
+bool FUntestModule::CanPipelineNextTest() const
+{
+	if (RunOpts.bPipelineSetup == false || RunningTests.Num() != 1 || RunningTests[0]->GetContext().TestType != EUntestTypeFlags::World)
+	{
+		return false;
+	}
+
+	const FUntestFixtureFactory* const* NextFactory = GetTestFactories().Find(QueuedTests.Last());
+	if (NextFactory == nullptr || (*NextFactory)->GetType() != EUntestTypeFlags::World)
+	{
+		return false;
+	}
+
+	return FUntestGarbageCollector::Get().IsCollectionDue() == false;
+}
+
+void FUntestModule::PreloadQueuedMaps() const
+{
+	FTestFactoryMap& Factories = GetTestFactories();
+	const int32 NumToPreload = FMath::Min(QueuedTests.Num(), MapPreloadLookahead);
+	for (int32 Index = 0; Index < NumToPreload; ++Index)
+	{
+		const FUntestFixtureFactory* const* Factory = Factories.Find(QueuedTests.Last(Index));
+		if (Factory == nullptr)
+		{
+			continue;
+		}
+
+		const FUntestOpts& Opts = (*Factory)->GetOpts();
+		if (Opts.IsSet(EUntestFlags::Disabled) == false || RunOpts.bIncludeDisabled)
+		{
+			FUntestMapPreloader::Get().Preload(Opts.MapPackageName);
+		}
+	}
+}
+
+void FUntestModule::SetReplicationSystem(EUntestReplicationSystem System)
+{
+	IConsoleVariable* CVar = FindUseIrisReplicationCVar();
+	if (CVar == nullptr || System == ReplicationSystem)
+	{
+		return;
+	}
+
+	if (ReplicationSystem == EUntestReplicationSystem::Default)
+	{
+		ProjectUseIrisReplication = CVar->GetInt();
+	}
+
+	ReplicationSystem = System;
+	if (System == EUntestReplicationSystem::Default)
+	{
+		CVar->Set(ProjectUseIrisReplication.Get(0), ECVF_SetByCode);
+		ProjectUseIrisReplication.Reset();
+	}
+	else
+	{
+		CVar->Set((System == EUntestReplicationSystem::Iris) ? 1 : 0, ECVF_SetByCode);
+	}
+}
+
+void FUntestModule::ReportLeaks()
+{
+	for (const FUntestLeak& Leak : FUntestGarbageCollector::Get().ConsumeLeaks())
+	{
+		const FString Error = FString::Printf(TEXT("Leaked %s: still alive after garbage collection. Something is holding a reference to it after the test finished."), *Leak.ObjectName);
+		UE_LOG(LogUntest, Error, TEXT("%s: %s"), *Leak.TestName, *Error);
+
+		// Compared tests have a result for each replication system, the leak belongs to the latest one
+		const int32 ResultsIndex = TestResults.FindLastByPredicate([&Leak](const FUntestResults& Results)
+			{
+				return Results.TestName.ToFull() == Leak.TestName;
+			});
+		if (ResultsIndex != INDEX_NONE)
+		{
+			TestResults[ResultsIndex].Result = EUntestResult::Fail;
+			TestResults[ResultsIndex].Errors.Emplace(Error);
+		}
+	}
+}
+
 UntestTask FUntestModule::RunTest(TSharedPtr<FUntestFixture> Fixture)
 {
-	Fixture->GetContext().TimestampBegin = FPlatformTime::Seconds();
+	FUntestContext& Context = Fixture->GetContext();
+	Context.TimestampBegin = FPlatformTime::Seconds();
+
+	if (Context.Suite.IsValid())
+	{
+		const double WaitBegin = FPlatformTime::Seconds();
+		Context.bWaitingToRun = true;
+		co_await SetupSuite(Context);
+		Context.bWaitingToRun = false;
+
+		// Setting up the suite is shared by all of its tests, so it doesn't count towards this one's duration
+		Context.TimestampBegin += FPlatformTime::Seconds() - WaitBegin;
+
+		if (Context.Errors.IsEmpty() == false)
+		{
+			Context.TimestampEnd = FPlatformTime::Seconds();
+			co_return;
+		}
+	}
 
 	co_await Fixture->SetupFixture(Fixture->GetContext().GetName().ToFull());
 
+	if (Context.RunAfterTask.IsDone() == false)
+	{
+		const double WaitBegin = FPlatformTime::Seconds();
+		Context.bWaitingToRun = true;
+		co_await Squid::WaitUntil([&Context]()
+			{
+				return Context.RunAfterTask.IsDone();
+			});
+		Context.bWaitingToRun = false;
+
+		// Time spent waiting for the previous test doesn't count towards this one's duration
+		Context.TimestampBegin += FPlatformTime::Seconds() - WaitBegin;
+	}
+
 	if (Fixture->GetContext().Errors.IsEmpty())
 	{
 		co_await Fixture->RunFixture(Fixture->GetContext().GetName().ToFull());
@@ -0,0 +1,348 @@
+#include "UntestNetSerialize.h"
+
+#include "Async/ParallelFor.h"
+#include "UObject/CoreNet.h"
+#include "UObject/EnumProperty.h"
+#include "UObject/UnrealType.h"
+
+// Iterations run by each worker thread task. Small enough to spread a default run over every worker.
+static constexpr int32 FuzzChunkSize = 256;
+
+static uint64 RandomBits64(FRandomStream& Random)
+{
+	return (static_cast<uint64>(Random.GetUnsignedInt()) << 32) | Random.GetUnsignedInt();
+}
+
+static int64 RandomEnumValue(const UEnum* Enum, FRandomStream& Random)
+{
+	// The last entry is the generated _MAX, which isn't a valid value
+	const int32 NumValues = Enum->ContainsExistingMax() ? Enum->NumEnums() - 1 : Enum->NumEnums();
+	return (NumValues > 0) ? Enum->GetValueByIndex(Random.RandRange(0, NumValues - 1)) : 0;
+}
+
+static FString RandomString(FRandomStream& Random, const FUntestNetSerializeFuzzOpts& Opts)
+{
+	FString String;
+	const int32 Length = Random.RandRange(0, Opts.MaxStringLength);
+	String.Reserve(Length);
+	for (int32 Index = 0; Index < Length; ++Index)
+	{
+		// Mostly printable ASCII, with some characters that need more than one byte when the string is sent as UTF-8
+		const bool bIsWide = Random.RandRange(0, 9) == 0;
+		String.AppendChar(static_cast<TCHAR>(bIsWide ? Random.RandRange(0x100, 0x7FF) : Random.RandRange(0x20, 0x7E)));
+	}
+	return String;
+}
+
+static void RandomizeElement(const FProperty* Property, void* ValuePtr, FRandomStream& Random, const FUntestNetSerializeFuzzOpts& Opts)
+{
+	if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+	{
+		BoolProperty->SetPropertyValue(ValuePtr, Random.RandRange(0, 1) == 1);
+	}
+	else if (const FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+	{
+		EnumProperty->GetUnderlyingProperty()->SetIntPropertyValue(ValuePtr, RandomEnumValue(EnumProperty->GetEnum(), Random));
+	}
+	else if (const FByteProperty* ByteProperty = CastField<FByteProperty>(Property); ByteProperty && ByteProperty->Enum)
+	{
+		ByteProperty->SetIntPropertyValue(ValuePtr, RandomEnumValue(ByteProperty->Enum, Random));
+	}
+	else if (const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+	{
+		if (NumericProperty->IsFloatingPoint())
+		{
+			NumericProperty->SetFloatingPointPropertyValue(ValuePtr, Random.FRandRange(-Opts.FloatRange, Opts.FloatRange));
+		}
+		else
+		{
+			// Truncated to the property's size, so every bit pattern is as likely
+			NumericProperty->SetIntPropertyValue(ValuePtr, RandomBits64(Random));
+		}
+	}
+	else if (const FStrProperty* StrProperty = CastField<FStrProperty>(Property))
+	{
+		StrProperty->SetPropertyValue(ValuePtr, RandomString(Random, Opts));
+	}
+	else if (const FNameProperty* NameProperty = CastField<FNameProperty>(Property))
+	{
+		// A small set of names, so fuzzing doesn't fill the name table
+		NameProperty->SetPropertyValue(ValuePtr, FName(TEXT("UntestFuzz"), Random.RandRange(0, 255)));
+	}
+	else if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+	{
+		UntestRandomizeStruct(StructProperty->Struct, ValuePtr, Random, Opts);
+	}
+	else if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+	{
+		FScriptArrayHelper Array(ArrayProperty, ValuePtr);
+		Array.Resize(Random.RandRange(0, Opts.MaxArrayNum));
+		for (int32 Index = 0; Index < Array.Num(); ++Index)
+		{
+			RandomizeElement(ArrayProperty->Inner, Array.GetRawPtr(Index), Random, Opts);
+		}
+	}
+}
+
+static void RandomizeProperty(const FProperty* Property, void* ContainerPtr, FRandomStream& Random, const FUntestNetSerializeFuzzOpts& Opts)
+{
+	for (int32 ArrayIndex = 0; ArrayIndex < Property->ArrayDim; ++ArrayIndex)
+	{
+		RandomizeElement(Property, Property->ContainerPtrToValuePtr<void>(ContainerPtr, ArrayIndex), Random, Opts);
+	}
+}
+
+void UntestRandomizeStruct(const UScriptStruct* Struct, void* Value, FRandomStream& Random, const FUntestNetSerializeFuzzOpts& Opts)
+{
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		RandomizeProperty(*It, Value, Random, Opts);
+	}
+}
+
+void UntestMutateStruct(const UScriptStruct* Struct, void* Value, FRandomStream& Random, const FUntestNetSerializeFuzzOpts& Opts)
+{
+	TArray<const FProperty*, TInlineAllocator<16>> Properties;
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		Properties.Add(*It);
+	}
+	if (Properties.IsEmpty())
+	{
+		return;
+	}
+
+	const FProperty* Property = Properties[Random.RandRange(0, Properties.Num() - 1)];
+	void* ElementPtr = Property->ContainerPtrToValuePtr<void>(Value, Random.RandRange(0, Property->ArrayDim - 1));
+	if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+	{
+		UntestMutateStruct(StructProperty->Struct, ElementPtr, Random, Opts);
+	}
+	else
+	{
+		RandomizeElement(Property, ElementPtr, Random, Opts);
+	}
+}
+
+namespace
+{
+	// Struct memory that's initialized and destroyed with the struct's own ops
+	struct FFuzzValue
+	{
+		explicit FFuzzValue(const UScriptStruct* InStruct)
+			: Struct(InStruct)
+		{
+			Memory = static_cast<uint8*>(FMemory::Malloc(Struct->GetStructureSize(), Struct->GetMinAlignment()));
+			Struct->InitializeStruct(Memory);
+		}
+
+		~FFuzzValue()
+		{
+			Struct->DestroyStruct(Memory);
+			FMemory::Free(Memory);
+		}
+
+		FFuzzValue(const FFuzzValue&) = delete;
+		FFuzzValue& operator=(const FFuzzValue&) = delete;
+
+		void CopyFrom(const FFuzzValue& Other) { Struct->CopyScriptStruct(Memory, Other.Memory); }
+		void Reset() { Struct->ClearScriptStruct(Memory); }
+
+		FString ToString() const
+		{
+			FString String;
+			Struct->ExportText(String, Memory, nullptr, nullptr, PPF_None, nullptr);
+			return String;
+		}
+
+		const UScriptStruct* Struct;
+		uint8* Memory;
+	};
+
+	struct FFuzzChunkResults
+	{
+		int32 Values = 0;
+		int32 Failures = 0;
+		int64 TotalBits = 0;
+		int64 MinBits = MAX_int64;
+		int64 MaxBits = 0;
+		uint64 WriteCycles = 0;
+		uint64 ReadCycles = 0;
+		TArray<FString> Errors;
+	};
+
+	struct FFuzzRoundTrip
+	{
+		int64 NumBits = 0;
+		FString Error; // Empty if the value was written and read back without the serializer failing
+	};
+} // namespace
+
+static FFuzzRoundTrip RoundTrip(UScriptStruct::ICppStructOps* StructOps, const FFuzzValue& Original, FFuzzValue& OutRoundTripped, FFuzzChunkResults& Results)
+{
+	FFuzzRoundTrip Trip;
+
+	FNetBitWriter Writer(nullptr, 0);
+	bool bWriteSuccess = true;
+	const uint64 WriteBegin = FPlatformTime::Cycles64();
+	StructOps->NetSerialize(Writer, nullptr, bWriteSuccess, Original.Memory);
+	Results.WriteCycles += FPlatformTime::Cycles64() - WriteBegin;
+
+	Trip.NumBits = Writer.GetNumBits();
+	if (bWriteSuccess == false || Writer.IsError())
+	{
+		Trip.Error = TEXT("writing failed");
+		return Trip;
+	}
+
+	OutRoundTripped.Reset();
+	FNetBitReader Reader(nullptr, Writer.GetData(), Writer.GetNumBits());
+	bool bReadSuccess = true;
+	const uint64 ReadBegin = FPlatformTime::Cycles64();
+	StructOps->NetSerialize(Reader, nullptr, bReadSuccess, OutRoundTripped.Memory);
+	Results.ReadCycles += FPlatformTime::Cycles64() - ReadBegin;
+
+	if (bReadSuccess == false || Reader.IsError())
+	{
+		Trip.Error = TEXT("reading failed");
+	}
+	else if (Reader.GetPosBits() != Writer.GetNumBits())
+	{
+		Trip.Error = FString::Printf(TEXT("read %lld of the %lld bits written"), Reader.GetPosBits(), Writer.GetNumBits());
+	}
+	return Trip;
+}
+
+FUntestNetSerializeFuzzResults UntestFuzzNetSerialize(FUntestContext& TestContext, const UScriptStruct* Struct, const FUntestNetSerializeFuzzOpts& Opts, const FUntestNetSerializeFuzzCallbacks& Callbacks)
+{
+	FUntestNetSerializeFuzzResults Results;
+
+	UScriptStruct::ICppStructOps* StructOps = Struct ? Struct->GetCppStructOps() : nullptr;
+	if (StructOps == nullptr || StructOps->HasNetSerializer() == false)
+	{
+		TestContext.AddError(FString::Printf(TEXT("%s has no NetSerialize() to fuzz"), Struct ? *Struct->GetName() : TEXT("<null>")));
+		return Results;
+	}
+
+	const int32 Seed = (Opts.Seed != 0) ? Opts.Seed : static_cast<int32>(GetTypeHash(TestContext.GetName().ToFull()));
+	const int32 NumChunks = FMath::DivideAndRoundUp(FMath::Max(Opts.Iterations, 0), FuzzChunkSize);
+
+	TArray<FFuzzChunkResults> ChunkResults;
+	ChunkResults.SetNum(NumChunks);
+
+	// Each chunk has its own random stream, so the values checked don't depend on how the chunks were scheduled
+	auto FuzzChunk = [Struct, StructOps, Seed, &Opts, &Callbacks, &ChunkResults](int32 ChunkIndex)
+	{
+		FFuzzChunkResults& Chunk = ChunkResults[ChunkIndex];
+		FRandomStream Random(static_cast<int32>(HashCombine(static_cast<uint32>(Seed), static_cast<uint32>(ChunkIndex))));
+
+		FFuzzValue Original(Struct);
+		FFuzzValue RoundTripped(Struct);
+		FFuzzValue RoundTrippedAgain(Struct);
+
+		const int32 FirstIteration = ChunkIndex * FuzzChunkSize;
+		const int32 LastIteration = FMath::Min(FirstIteration + FuzzChunkSize, Opts.Iterations);
+		for (int32 Iteration = FirstIteration; Iteration < LastIteration; ++Iteration)
+		{
+			// Mutations start from the previous value, which is still in Original
+			const bool bMutate = Iteration > FirstIteration && Random.FRandRange(0.0f, 100.0f) < Opts.MutatePercent;
+			if (bMutate)
+			{
+				Callbacks.Mutate(Original.Memory, Random);
+			}
+			else
+			{
+				Original.Reset();
+				Callbacks.Generate(Original.Memory, Random);
+			}
+
+			++Chunk.Values;
+
+			const FFuzzRoundTrip Trip = RoundTrip(StructOps, Original, RoundTripped, Chunk);
+			Chunk.TotalBits += Trip.NumBits;
+			Chunk.MinBits = FMath::Min(Chunk.MinBits, Trip.NumBits);
+			Chunk.MaxBits = FMath::Max(Chunk.MaxBits, Trip.NumBits);
+
+			FString Error = Trip.Error;
+			if (Error.IsEmpty() && Callbacks.IsEquivalent(Original.Memory, RoundTripped.Memory) == false)
+			{
+				Error = TEXT("value changed");
+			}
+			if (Error.IsEmpty())
+			{
+				// Anything lost was lost the first time, so a value that was read back has to survive unchanged
+				const FFuzzRoundTrip SecondTrip = RoundTrip(StructOps, RoundTripped, RoundTrippedAgain, Chunk);
+				if (SecondTrip.Error.IsEmpty() == false)
+				{
+					Error = FString::Printf(TEXT("second round trip %s"), *SecondTrip.Error);
+				}
+				else if (Struct->CompareScriptStruct(RoundTripped.Memory, RoundTrippedAgain.Memory, PPF_None) == false)
+				{
+					Error = TEXT("value changed again on the second round trip");
+				}
+			}
+
+			if (Error.IsEmpty() == false)
+			{
+				++Chunk.Failures;
+				if (Chunk.Errors.Num() < Opts.MaxReportedFailures)
+				{
+					Chunk.Errors.Emplace(FString::Printf(TEXT("Value %d (seed %d, %s): %s. Original: %s Read back: %s"),
+						Iteration, Seed, bMutate ? TEXT("mutated") : TEXT("random"), *Error, *Original.ToString(), *RoundTripped.ToString()));
+				}
+			}
+		}
+	};
+	ParallelFor(NumChunks, FuzzChunk, Opts.bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+	int64 TotalBits = 0;
+	uint64 WriteCycles = 0;
+	uint64 ReadCycles = 0;
+	int64 MinBits = MAX_int64;
+	int32 NumReportedErrors = 0;
+	for (FFuzzChunkResults& Chunk : ChunkResults)
+	{
+		Results.Values += Chunk.Values;
+		Results.Failures += Chunk.Failures;
+		MinBits = FMath::Min(MinBits, Chunk.MinBits);
+		Results.MaxBits = FMath::Max(Results.MaxBits, Chunk.MaxBits);
+		TotalBits += Chunk.TotalBits;
+		WriteCycles += Chunk.WriteCycles;
+		ReadCycles += Chunk.ReadCycles;
+
+		for (FString& Error : Chunk.Errors)
+		{
+			if (NumReportedErrors++ < Opts.MaxReportedFailures)
+			{
+				TestContext.AddError(MoveTemp(Error));
+			}
+		}
+	}
+
+	if (Results.Failures > NumReportedErrors)
+	{
+		TestContext.AddError(FString::Printf(TEXT("%d of %d values failed to round trip through %s::NetSerialize()"), Results.Failures, Results.Values, *Struct->GetName()));
+	}
+
+	Results.NativeBits = Struct->GetStructureSize() * 8;
+	if (Results.Values > 0)
+	{
+		// Values that failed to write still count, since they were written up to where they failed
+		const double NsPerCycle = FPlatformTime::GetSecondsPerCycle64() * 1e9;
+		Results.MinBits = MinBits;
+		Results.AvgBits = static_cast<double>(TotalBits) / Results.Values;
+		Results.AvgWriteNs = WriteCycles * NsPerCycle / Results.Values;
+		Results.AvgReadNs = ReadCycles * NsPerCycle / Results.Values;
+
+		TestContext.AddMetric(TEXT("NetSerialize.Values"), Results.Values);
+		TestContext.AddMetric(TEXT("NetSerialize.Seed"), Seed);
+		TestContext.AddMetric(TEXT("NetSerialize.Bits.Avg"), Results.AvgBits);
+		TestContext.AddMetric(TEXT("NetSerialize.Bits.Min"), Results.MinBits);
+		TestContext.AddMetric(TEXT("NetSerialize.Bits.Max"), Results.MaxBits);
+		TestContext.AddMetric(TEXT("NetSerialize.NativeBits"), Results.NativeBits);
+		TestContext.AddMetric(TEXT("NetSerialize.WriteNs.Avg"), Results.AvgWriteNs);
+		TestContext.AddMetric(TEXT("NetSerialize.ReadNs.Avg"), Results.AvgReadNs);
+	}
+
+	return Results;
+}
@@ -0,0 +1,226 @@
+#include "UntestReplay.h"
+#include "UntestWorldPool.h"
+
+#include "Engine/DemoNetDriver.h"
+#include "Engine/Engine.h"
+#include "Engine/LocalPlayer.h"
+
+// PIE instance of the replay world's package prefix. ClientServer worlds use instances 0 to NumClients, so a high number
+// keeps the package from colliding with one of a pooled pair that still exists.
+static constexpr int32 ReplayPIEInstance = 1000;
+
+FUntestReplayTestFixture::~FUntestReplayTestFixture()
+{
+	// Only does anything when the test didn't get to tear down normally, e.g. it timed out
+	DestroyReplayWorld();
+}
+
+UDemoNetDriver* FUntestReplayTestFixture::GetDemoNetDriver()
+{
+	UWorld* World = GetContext().GetWorld(EUntestWorldType::Server);
+	return World ? World->GetDemoNetDriver() : nullptr;
+}
+
+UntestTask FUntestReplayTestFixture::SetupFixture(const FString TestName)
+{
+	FUntestContext& TestContext = GetContext();
+	const FUntestReplayOpts Opts = GetReplayOpts();
+	if (Opts.ReplayName.IsEmpty() || Opts.RecordedTestName.IsEmpty())
+	{
+		TestContext.AddError(TEXT("Replay fixtures need a ReplayName and the RecordedTestName that recorded it"));
+		co_return;
+	}
+
+	ReplayTestName = TestName;
+
+	// Same package and world names as the recording server's world (see FBVClientServerTestFixture::SetupFixture()).
+	// Package names are remapped without their PIE prefix when resolving net paths, so the replay's paths resolve here.
+	FString PackageCommonName = FString::Printf(TEXT("TestPackage_%s"), *Opts.RecordedTestName);
+	PackageCommonName.ReplaceCharInline('.', '_');
+	PackageName = FName(*FString::Printf(TEXT("/Untest/%s%s"), *UWorld::BuildPIEPackagePrefix(ReplayPIEInstance), *PackageCommonName));
+	FUntestClientServerPool::Get().AddPIEPackageName(PackageName);
+
+	UPackage* Package = NewObject<UPackage>(nullptr, PackageName);
+	Package->SetPackageFlags(PKG_NewlyCreated);
+	Package->AddToRoot();
+	Package->MarkAsFullyLoaded();
+	TestContext.Packages[EUntestWorldType::Server] = Package;
+
+	UUntestGameInstance* GameInstance = NewObject<UUntestGameInstance>(Package);
+	TestContext.GameInstances[EUntestWorldType::Server] = GameInstance;
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.PIEInstance = ReplayPIEInstance;
+	WorldContext.OwningGameInstance = GameInstance;
+	GameInstance->SetWorldContext(&WorldContext);
+	GameInstance->Init();
+	GameInstance->ClearFlags(RF_Standalone);
+	GameInstance->AddToRoot();
+
+	const FName WorldName = FName(*FString::Printf(TEXT("TestWorld_%s"), *Opts.RecordedTestName));
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false /*bInformEngineOfWorld*/, WorldName, Package, false /*bAddToRoot*/, ERHIFeatureLevel::Num, nullptr, true /*bSkipInitWorld*/);
+	if (World == nullptr)
+	{
+		TestContext.AddError(TEXT("Failed to create replay world"));
+		co_return;
+	}
+
+	World->SetGameInstance(GameInstance);
+	World->ClearFlags(RF_Standalone);
+	World->SetPlayInEditorInitialNetMode(NM_Client);
+	World->bAllowAudioPlayback = false;
+	World->bIsNameStableForNetworking = true;
+	WorldContext.SetCurrentWorld(World);
+	TestContext.Worlds[EUntestWorldType::Server] = World;
+
+	World->InitWorld(UWorld::InitializationValues());
+	World->InitializeActorsForPlay(FURL(), true /*bResetTime*/);
+
+	// Playback spawns a spectator controller for the viewer, which asserts a ULocalPlayer exists
+	ULocalPlayer* LocalPlayer = NewObject<ULocalPlayer>(GEngine, ULocalPlayer::StaticClass());
+	GameInstance->AddLocalPlayer(LocalPlayer, IPlatformInputDeviceMapper::Get().GetPrimaryPlatformUser());
+
+	World->BeginPlay();
+
+	GameInstance->PlayReplay(Opts.ReplayName, World);
+
+	// Streamers load the header and first checkpoint asynchronously. Replay time doesn't advance until they're done.
+	int32 LoadTicks = 0;
+	auto IsLoadedFunc = [this, World, &Opts, &LoadTicks]()
+	{
+		World->Tick(LEVELTICK_All, Opts.StepSeconds);
+
+		const UDemoNetDriver* DemoNetDriver = GetDemoNetDriver();
+		const bool bIsLoaded = DemoNetDriver && DemoNetDriver->IsPlaying() && DemoNetDriver->IsLoadingCheckpoint() == false && DemoNetDriver->GetDemoTotalTime() > 0.0f;
+		return bIsLoaded || ++LoadTicks > Opts.MaxLoadTicks;
+	};
+	co_await Squid::WaitUntil(IsLoadedFunc);
+
+	if (LoadTicks > Opts.MaxLoadTicks)
+	{
+		TestContext.AddError(FString::Printf(TEXT("Replay '%s' didn't load within %d ticks. Was it recorded by %s?"), *Opts.ReplayName, Opts.MaxLoadTicks, *Opts.RecordedTestName));
+		co_return;
+	}
+
+	co_await Setup(TestContext);
+}
+
+UntestTask FUntestReplayTestFixture::RunFixture(const FString TestName)
+{
+	FUntestContext& TestContext = GetContext();
+	const FUntestReplayOpts Opts = GetReplayOpts();
+	UWorld* World = TestContext.GetWorld(EUntestWorldType::Server);
+
+	// Playback can stop between setup and run, e.g. while the test waited to run behind another one
+	const UDemoNetDriver* DemoNetDriverBegin = GetDemoNetDriver();
+	if (DemoNetDriverBegin == nullptr)
+	{
+		TestContext.AddError(FString::Printf(TEXT("Replay '%s' stopped playing before the test could run"), *Opts.ReplayName));
+		co_return;
+	}
+
+	UntestTask Task = Run(TestContext, EUntestWorldType::Server);
+
+	const double PlaybackBegin = FPlatformTime::Seconds();
+	const float DemoTimeBegin = DemoNetDriverBegin->GetDemoCurrentTime();
+
+	int32 NumTicks = 0;
+	double TotalTickMs = 0.0;
+	double MaxTickMs = 0.0;
+
+	auto IsFinished = [this]()
+	{
+		const UDemoNetDriver* DemoNetDriver = GetDemoNetDriver();
+		return DemoNetDriver == nullptr || DemoNetDriver->GetDemoCurrentTime() >= DemoNetDriver->GetDemoTotalTime();
+	};
+
+	// Ticks back to back instead of once per runner frame, only yielding now and then so timeouts and the UI keep working
+	auto PlaybackFunc = [this, World, &Opts, &Task, &NumTicks, &TotalTickMs, &MaxTickMs, &IsFinished]()
+	{
+		// Once playback has ended there's nothing left to tick, the test is only resumed until it's done
+		if (IsFinished())
+		{
+			if (Task.IsDone() == false)
+			{
+				Task.Resume();
+			}
+			return Task.IsDone();
+		}
+
+		const double FrameBegin = FPlatformTime::Seconds();
+		do
+		{
+			const double TickBegin = FPlatformTime::Seconds();
+			World->Tick(LEVELTICK_All, Opts.StepSeconds);
+			const double TickMs = (FPlatformTime::Seconds() - TickBegin) * 1000.0;
+
+			++NumTicks;
+			TotalTickMs += TickMs;
+			MaxTickMs = FMath::Max(MaxTickMs, TickMs);
+
+			++GetContext().FrameNumber;
+			if (Task.IsDone() == false)
+			{
+				Task.Resume();
+			}
+
+			if (IsFinished())
+			{
+				return Task.IsDone();
+			}
+		} while ((FPlatformTime::Seconds() - FrameBegin) * 1000.0 < Opts.MaxFrameMs);
+
+		return false;
+	};
+
+	co_await Squid::WaitUntil(PlaybackFunc);
+
+	const double PlaybackSeconds = FPlatformTime::Seconds() - PlaybackBegin;
+	const UDemoNetDriver* DemoNetDriver = GetDemoNetDriver();
+	const double DemoSeconds = DemoNetDriver ? DemoNetDriver->GetDemoCurrentTime() - DemoTimeBegin : 0.0;
+	if (NumTicks > 0)
+	{
+		TestContext.AddMetric(TEXT("Replay.Ticks"), NumTicks);
+		TestContext.AddMetric(TEXT("Replay.DemoSeconds"), DemoSeconds);
+		TestContext.AddMetric(TEXT("Replay.TickMs.Avg"), TotalTickMs / NumTicks);
+		TestContext.AddMetric(TEXT("Replay.TickMs.Max"), MaxTickMs);
+		TestContext.AddMetric(TEXT("Replay.Speedup"), (PlaybackSeconds > 0.0) ? DemoSeconds / PlaybackSeconds : 0.0);
+	}
+}
+
+UntestTask FUntestReplayTestFixture::TeardownFixture(const FString TestName)
+{
+	co_await Teardown(GetContext());
+
+	DestroyTestObjects();
+	DestroyReplayWorld();
+}
+
+void FUntestReplayTestFixture::DestroyReplayWorld()
+{
+	FUntestContext& TestContext = GetContext();
+	UWorld* World = TestContext.Worlds[EUntestWorldType::Server].Get();
+	UGameInstance* GameInstance = TestContext.GameInstances[EUntestWorldType::Server].Get();
+	UPackage* Package = TestContext.Packages[EUntestWorldType::Server].Get();
+
+	// Replay worlds are never pooled: playback leaves the world in the state of the recording's end
+	if (World)
+	{
+		if (UDemoNetDriver* DemoNetDriver = World->GetDemoNetDriver())
+		{
+			GEngine->DestroyNamedNetDriver(World, DemoNetDriver->NetDriverName);
+			World->SetDemoNetDriver(nullptr);
+		}
+	}
+	UntestDestroyWorld(ReplayTestName, World, GameInstance, Package);
+
+	if (PackageName.IsNone() == false)
+	{
+		FUntestClientServerPool::Get().RemovePIEPackageNames(MakeArrayView(&PackageName, 1));
+		PackageName = NAME_None;
+	}
+
+	TestContext.Worlds[EUntestWorldType::Server].Reset();
+	TestContext.GameInstances[EUntestWorldType::Server].Reset();
+	TestContext.Packages[EUntestWorldType::Server].Reset();
+}
@@ -0,0 +1,280 @@
+#include "UntestReplicationAudit.h"
+
+#include "Engine/NetDriver.h"
+#include "Engine/NetworkObjectList.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Net/UnrealNetwork.h"
+
+namespace
+{
+	// Auditors of the ClientServer tests currently running, so dirty marks can find the one auditing their world
+	TArray<FUntestReplicationAuditor*> ActiveAuditors;
+} // namespace
+
+// Copy of one replicated property element, compared against the live value on every sample
+struct FUntestReplicationAuditor::FPropertyShadow
+{
+	FPropertyShadow(const FProperty* InProperty, const void* Value)
+		: Property(InProperty)
+	{
+		Memory = FMemory::Malloc(Property->GetElementSize(), Property->GetMinAlignment());
+		Property->InitializeValue(Memory);
+		Property->CopySingleValue(Memory, Value);
+	}
+
+	~FPropertyShadow()
+	{
+		Property->DestroyValue(Memory);
+		FMemory::Free(Memory);
+	}
+
+	FPropertyShadow(const FPropertyShadow&) = delete;
+	FPropertyShadow& operator=(const FPropertyShadow&) = delete;
+
+	// Returns true and takes the new value if it changed since the last call
+	bool Update(const void* Value)
+	{
+		if (Property->Identical(Memory, Value))
+		{
+			return false;
+		}
+		Property->CopySingleValue(Memory, Value);
+		return true;
+	}
+
+	const FProperty* Property;
+	void* Memory;
+};
+
+struct FUntestReplicationAuditor::FActorState
+{
+	TArray<TUniquePtr<FPropertyShadow>> Shadows; // Parallel to the class's audited properties
+	double LastNetReplicateTime = 0.0;
+	int32 UnchangedFrames = 0;
+	bool bIsDormancyCandidate = false;
+};
+
+FUntestReplicationAuditor::FUntestReplicationAuditor(UWorld* InServerWorld, const FUntestReplicationAuditOpts& InOpts)
+	: ServerWorld(InServerWorld)
+	, Opts(InOpts)
+{
+	ActiveAuditors.Add(this);
+}
+
+FUntestReplicationAuditor::~FUntestReplicationAuditor()
+{
+	ActiveAuditors.RemoveSingleSwap(this);
+}
+
+void FUntestReplicationAuditor::NotifyPropertyDirty(const UObject* Object, FName PropertyName)
+{
+	const UWorld* World = Object ? Object->GetWorld() : nullptr;
+	for (FUntestReplicationAuditor* Auditor : ActiveAuditors)
+	{
+		if (World && Auditor->ServerWorld.Get() == World)
+		{
+			Auditor->PendingDirtyMarks.FindOrAdd(Object).AddUnique(PropertyName);
+		}
+	}
+}
+
+const TArray<FUntestReplicationAuditor::FAuditedProperty>& FUntestReplicationAuditor::GetAuditedProperties(const UClass* Class)
+{
+	if (const TArray<FAuditedProperty>* Existing = ClassProperties.Find(Class))
+	{
+		return *Existing;
+	}
+
+	TArray<FAuditedProperty>& Properties = ClassProperties.Add(Class);
+	FUntestReplicationAuditClass& Results = ClassResults.FindOrAdd(Class);
+
+	// The lifetime properties say which properties are push model and which are never compared after the initial bunch
+	TArray<FLifetimeProperty> LifetimeProperties;
+	Class->GetDefaultObject<AActor>()->GetLifetimeReplicatedProps(LifetimeProperties);
+
+	for (const FLifetimeProperty& LifetimeProperty : LifetimeProperties)
+	{
+		if (LifetimeProperty.Condition == COND_InitialOnly || LifetimeProperty.Condition == COND_Never || Class->ClassReps.IsValidIndex(LifetimeProperty.RepIndex) == false)
+		{
+			continue;
+		}
+
+		const FRepRecord& RepRecord = Class->ClassReps[LifetimeProperty.RepIndex];
+
+		FAuditedProperty& Property = Properties.AddDefaulted_GetRef();
+		Property.Property = RepRecord.Property;
+		Property.ArrayIndex = RepRecord.Index;
+		Property.bPushModel = LifetimeProperty.bIsPushBased;
+		Property.StatIndex = Results.Properties.IndexOfByPredicate([&RepRecord](const FUntestReplicationAuditProperty& Stats)
+			{
+				return Stats.Name == RepRecord.Property->GetFName();
+			});
+
+		// Static array elements share their property's results
+		if (Property.StatIndex == INDEX_NONE)
+		{
+			Property.StatIndex = Results.Properties.Num();
+			FUntestReplicationAuditProperty& Stats = Results.Properties.AddDefaulted_GetRef();
+			Stats.Name = RepRecord.Property->GetFName();
+			Stats.bPushModel = Property.bPushModel;
+		}
+	}
+
+	return Properties;
+}
+
+void FUntestReplicationAuditor::Sample()
+{
+	UWorld* World = ServerWorld.Get();
+	UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+	if (NetDriver == nullptr)
+	{
+		return;
+	}
+
+	// Dormant actors aren't in the list, which is right: nothing of theirs is compared until they wake up
+	const FNetworkObjectList& NetworkObjects = NetDriver->GetNetworkObjectList();
+	for (const TSharedPtr<FNetworkObjectInfo>& ObjectInfo : NetworkObjects.GetActiveObjects())
+	{
+		AActor* Actor = ObjectInfo.IsValid() ? ObjectInfo->Actor : nullptr;
+		if (IsValid(Actor))
+		{
+			SampleActor(Actor, ObjectInfo->LastNetReplicateTime);
+		}
+	}
+
+	PendingDirtyMarks.Reset();
+
+	// Destroyed actors
+	if (ActorStates.Num() > NetworkObjects.GetAllObjects().Num())
+	{
+		for (auto It = ActorStates.CreateIterator(); It; ++It)
+		{
+			if (It->Key.IsValid() == false)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+}
+
+void FUntestReplicationAuditor::SampleActor(AActor* Actor, double LastNetReplicateTime)
+{
+	const UClass* Class = Actor->GetClass();
+	const TArray<FAuditedProperty>& Properties = GetAuditedProperties(Class);
+	FUntestReplicationAuditClass& Results = ClassResults.FindChecked(Class);
+
+	TUniquePtr<FActorState>& State = ActorStates.FindOrAdd(Actor);
+	if (State.IsValid() == false)
+	{
+		// Nothing to compare against yet
+		State = MakeUnique<FActorState>();
+		State->LastNetReplicateTime = LastNetReplicateTime;
+		State->Shadows.Reserve(Properties.Num());
+		for (const FAuditedProperty& Property : Properties)
+		{
+			State->Shadows.Emplace(MakeUnique<FPropertyShadow>(Property.Property, Property.Property->ContainerPtrToValuePtr<void>(Actor, Property.ArrayIndex)));
+		}
+		++Results.Actors;
+		return;
+	}
+
+	// The NetDriver stamps actors it considered for replication this frame, which is when their properties get compared
+	const bool bWasReplicated = LastNetReplicateTime != State->LastNetReplicateTime;
+	State->LastNetReplicateTime = LastNetReplicateTime;
+
+	const TArray<FName>* DirtyMarks = PendingDirtyMarks.Find(Actor);
+
+	bool bAnyChanged = false;
+	for (int32 Index = 0; Index < Properties.Num(); ++Index)
+	{
+		const FAuditedProperty& Property = Properties[Index];
+		if (State->Shadows[Index]->Update(Property.Property->ContainerPtrToValuePtr<void>(Actor, Property.ArrayIndex)))
+		{
+			bAnyChanged = true;
+			continue;
+		}
+
+		FUntestReplicationAuditProperty& Stats = Results.Properties[Property.StatIndex];
+		if (bWasReplicated && Property.bPushModel == false)
+		{
+			++Stats.WastedComparisons;
+			++Results.WastedComparisons;
+		}
+		if (DirtyMarks && DirtyMarks->Contains(Property.Property->GetFName()))
+		{
+			++Stats.DirtyUnchanged;
+			++Results.DirtyUnchanged;
+		}
+	}
+
+	// Only actors that are always awake could have been dormant instead
+	if (Actor->NetDormancy <= DORM_Awake)
+	{
+		State->UnchangedFrames = bAnyChanged ? 0 : State->UnchangedFrames + 1;
+		if (State->bIsDormancyCandidate == false && State->UnchangedFrames >= Opts.DormancyCandidateFrames)
+		{
+			State->bIsDormancyCandidate = true;
+			++Results.DormancyCandidates;
+		}
+	}
+}
+
+FUntestReplicationAuditClass FUntestReplicationAuditor::GetTotals(const UClass* Class) const
+{
+	FUntestReplicationAuditClass Totals;
+	for (const TPair<const UClass*, FUntestReplicationAuditClass>& Pair : ClassResults)
+	{
+		if (Pair.Key->IsChildOf(Class))
+		{
+			Totals.Actors += Pair.Value.Actors;
+			Totals.DormancyCandidates += Pair.Value.DormancyCandidates;
+			Totals.WastedComparisons += Pair.Value.WastedComparisons;
+			Totals.DirtyUnchanged += Pair.Value.DirtyUnchanged;
+		}
+	}
+	return Totals;
+}
+
+void FUntestReplicationAuditor::RecordMetrics(FUntestContext& TestContext) const
+{
+	// Classes without waste would only add noise to the report
+	for (const TPair<const UClass*, FUntestReplicationAuditClass>& Pair : ClassResults)
+	{
+		const FUntestReplicationAuditClass& Results = Pair.Value;
+		if (Results.HasWaste() == false)
+		{
+			continue;
+		}
+
+		const FString Prefix = FString::Printf(TEXT("ReplicationAudit.%s."), *Pair.Key->GetName());
+		TestContext.AddMetric(Prefix + TEXT("Actors"), Results.Actors);
+		TestContext.AddMetric(Prefix + TEXT("DormancyCandidates"), Results.DormancyCandidates);
+		TestContext.AddMetric(Prefix + TEXT("WastedComparisons"), Results.WastedComparisons);
+		TestContext.AddMetric(Prefix + TEXT("DirtyUnchanged"), Results.DirtyUnchanged);
+
+		for (const FUntestReplicationAuditProperty& Property : Results.Properties)
+		{
+			if (Property.WastedComparisons > 0)
+			{
+				TestContext.AddMetric(FString::Printf(TEXT("%s%s.WastedComparisons"), *Prefix, *Property.Name.ToString()), Property.WastedComparisons);
+			}
+			if (Property.DirtyUnchanged > 0)
+			{
+				TestContext.AddMetric(FString::Printf(TEXT("%s%s.DirtyUnchanged"), *Prefix, *Property.Name.ToString()), Property.DirtyUnchanged);
+			}
+		}
+	}
+}
+
+FUntestReplicationAuditClass UntestGetReplicationAudit(FUntestContext& TestContext, const UClass* Class)
+{
+	const FUntestReplicationAuditor* Auditor = TestContext.GetReplicationAuditor();
+	if (Auditor == nullptr)
+	{
+		TestContext.AddError(TEXT("Replication audit checks need the fixture to enable the audit in GetReplicationAuditOpts()"));
+		return FUntestReplicationAuditClass();
+	}
+	return Auditor->GetTotals(Class);
+}
@@ -0,0 +1,109 @@
+#include "UntestReplicationGraphProbe.h"
+#include "UntestLoopbackNetDriver.h"
+
+#include "Engine/NetDriver.h"
+
+// Global nodes are protected, but the probe has to run before the graph's own nodes
+struct FUntestReplicationGraphAccess : public UReplicationGraph
+{
+	static TArray<TObjectPtr<UReplicationGraphNode>>& GetGlobalGraphNodes(UReplicationGraph& Graph)
+	{
+		return Graph.*(&FUntestReplicationGraphAccess::GlobalGraphNodes);
+	}
+};
+
+UUntestReplicationGraphProbe* UUntestReplicationGraphProbe::Install(UReplicationGraph* Graph)
+{
+	check(Graph);
+
+	if (UUntestReplicationGraphProbe* ExistingProbe = Find(Graph->NetDriver))
+	{
+		return ExistingProbe;
+	}
+
+	UUntestReplicationGraphProbe* Probe = Graph->CreateNewNode<UUntestReplicationGraphProbe>();
+	Probe->Graph = Graph;
+	FUntestReplicationGraphAccess::GetGlobalGraphNodes(*Graph).Insert(Probe, 0);
+
+	if (UUntestLoopbackNetDriver* LoopbackNetDriver = Cast<UUntestLoopbackNetDriver>(Graph->NetDriver))
+	{
+		LoopbackNetDriver->OnPostServerReplicateActors().AddUObject(Probe, &UUntestReplicationGraphProbe::MarkReplicateActorsEnd);
+	}
+
+	return Probe;
+}
+
+UUntestReplicationGraphProbe* UUntestReplicationGraphProbe::Find(UNetDriver* NetDriver)
+{
+	UReplicationGraph* Graph = NetDriver ? Cast<UReplicationGraph>(NetDriver->GetReplicationDriver()) : nullptr;
+	if (Graph == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (UReplicationGraphNode* Node : FUntestReplicationGraphAccess::GetGlobalGraphNodes(*Graph))
+	{
+		UUntestReplicationGraphProbe* Probe = Cast<UUntestReplicationGraphProbe>(Node);
+		if (Probe && Probe->StartProbe == nullptr)
+		{
+			return Probe;
+		}
+	}
+	return nullptr;
+}
+
+void UUntestReplicationGraphProbe::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	const double Now = FPlatformTime::Seconds();
+	if (StartProbe)
+	{
+		StartProbe->EndGather(Params.ConnectionManager.NetConnection, Now);
+	}
+	else
+	{
+		BeginGather(Params.ConnectionManager, Now);
+	}
+}
+
+void UUntestReplicationGraphProbe::BeginGather(UNetReplicationGraphConnection& ConnectionManager, double Now)
+{
+	EndPrioritize(Now);
+	GatherBegin = Now;
+
+	// The graph adds its own connection nodes when the client connects, so appending ours the first time the connection
+	// is gathered puts it after all of them
+	if (!ConnectionsWithEndProbe.Contains(ConnectionManager.NetConnection))
+	{
+		UUntestReplicationGraphProbe* EndProbe = Graph->CreateNewNode<UUntestReplicationGraphProbe>();
+		EndProbe->StartProbe = this;
+		Graph->AddConnectionGraphNode(EndProbe, &ConnectionManager);
+		ConnectionsWithEndProbe.Add(ConnectionManager.NetConnection);
+	}
+}
+
+void UUntestReplicationGraphProbe::EndGather(UNetConnection* Connection, double Now)
+{
+	FUntestConnectionReplicationTimings& ConnectionTimings = Timings.FindOrAdd(Connection);
+	ConnectionTimings.GatherSeconds += Now - GatherBegin;
+	++ConnectionTimings.Frames;
+
+	PrioritizingConnection = Connection;
+	PrioritizeBegin = Now;
+	PrioritizeFrame = Graph->GetReplicationGraphFrame();
+}
+
+void UUntestReplicationGraphProbe::EndPrioritize(double Now)
+{
+	// Left open by the previous frame when nothing marked its end, in which case it includes everything the server did
+	// in between and is dropped
+	if (PrioritizingConnection.IsValid() && PrioritizeFrame == Graph->GetReplicationGraphFrame())
+	{
+		Timings.FindOrAdd(PrioritizingConnection).PrioritizeSeconds += Now - PrioritizeBegin;
+	}
+	PrioritizingConnection.Reset();
+}
+
+void UUntestReplicationGraphProbe::MarkReplicateActorsEnd()
+{
+	EndPrioritize(FPlatformTime::Seconds());
+}
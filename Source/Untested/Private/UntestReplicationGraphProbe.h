@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ReplicationGraph.h"
+#include "UntestReplicationGraphProbe.generated.h"
+
+// Time a ReplicationGraph spent on one client connection
+struct FUntestConnectionReplicationTimings
+{
+	int32 Frames = 0;
+	double GatherSeconds = 0.0;		// Running every node's GatherActorListsForConnection()
+	double PrioritizeSeconds = 0.0; // Everything after gathering: prioritizing, replicating and sending the lists
+};
+
+// Installed into a test server's ReplicationGraph to time each connection's gather and prioritization. One probe runs
+// before every other global node, and a second one after the connection's own nodes, so the time between them is
+// the gather. The time from there until the next connection starts is prioritization and replication. The last
+// connection of a frame is only measured with the loopback driver, which reports when ServerReplicateActors() returns.
+UCLASS(Transient)
+class UUntestReplicationGraphProbe : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+	// Adds the probes to Graph if it doesn't have them yet, and returns the start probe
+	static UUntestReplicationGraphProbe* Install(UReplicationGraph* Graph);
+	static UUntestReplicationGraphProbe* Find(UNetDriver* NetDriver);
+
+	void ResetTimings() { Timings.Reset(); }
+	const FUntestConnectionReplicationTimings* GetTimings(const UNetConnection* Connection) const { return Timings.Find(Connection); }
+
+	// Closes the last connection's prioritization, since the graph has no hook for it
+	void MarkReplicateActorsEnd();
+
+	// UReplicationGraphNode
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo) override {}
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound = true) override { return false; }
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+private:
+	void BeginGather(UNetReplicationGraphConnection& ConnectionManager, double Now);
+	void EndGather(UNetConnection* Connection, double Now);
+	void EndPrioritize(double Now);
+
+	UPROPERTY()
+	TObjectPtr<UUntestReplicationGraphProbe> StartProbe; // Set on the end probes, which report back to the start probe
+
+	UPROPERTY()
+	TObjectPtr<UReplicationGraph> Graph;
+
+	TMap<TWeakObjectPtr<const UNetConnection>, FUntestConnectionReplicationTimings> Timings;
+	TSet<TWeakObjectPtr<const UNetConnection>> ConnectionsWithEndProbe;
+	double GatherBegin = 0.0;
+	double PrioritizeBegin = 0.0;
+	uint32 PrioritizeFrame = 0;
+	TWeakObjectPtr<const UNetConnection> PrioritizingConnection;
+};
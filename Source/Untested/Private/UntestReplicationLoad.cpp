@@ -0,0 +1,157 @@
+#include "UntestReplicationLoad.h"
+#include "UntestLoopbackNetDriver.h"
+
+#include "EngineUtils.h"
+#include "Net/UnrealNetwork.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AUntestReplicationLoadActor
+
+AUntestReplicationLoadActor::AUntestReplicationLoadActor()
+{
+	bReplicates = true;
+	bAlwaysRelevant = true; // Keeps relevancy checks out of the measurement, there are no player pawns to be near
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+void AUntestReplicationLoadActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AUntestReplicationLoadActor, Counter);
+	DOREPLIFETIME(AUntestReplicationLoadActor, Value);
+	DOREPLIFETIME(AUntestReplicationLoadActor, Position);
+}
+
+void AUntestReplicationLoadActor::Churn()
+{
+	++Counter;
+	Value = FMath::FRand();
+	Position = FMath::VRand() * 1000.0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FUntestReplicationLoadFixture
+
+static double GetClientReceiveSeconds(FUntestContext& TestContext)
+{
+	double ReceiveSeconds = 0.0;
+	for (int32 ClientIndex = 0; ClientIndex < TestContext.GetNumClients(); ++ClientIndex)
+	{
+		const UWorld* World = TestContext.GetWorld(static_cast<EUntestWorldType::Enum>(EUntestWorldType::Client + ClientIndex));
+		if (const UUntestLoopbackNetDriver* NetDriver = World ? Cast<UUntestLoopbackNetDriver>(World->GetNetDriver()) : nullptr)
+		{
+			ReceiveSeconds += NetDriver->GetCounters().ReceiveSeconds;
+		}
+	}
+	return ReceiveSeconds;
+}
+
+UntestTask FUntestReplicationLoadFixture::RunReplicationLoad(FUntestContext& TestContext, const EUntestWorldType::Enum WorldType)
+{
+	// The server drives every step. The clients only have to keep ticking, which the fixture does until all worlds are done.
+	if (WorldType == EUntestWorldType::Server)
+	{
+		co_await RunServerLoad(TestContext);
+	}
+}
+
+UntestTask FUntestReplicationLoadFixture::RunServerLoad(FUntestContext& TestContext)
+{
+	const FUntestReplicationLoadOpts Opts = GetReplicationLoadOpts();
+	UWorld* ServerWorld = TestContext.GetWorld(EUntestWorldType::Server);
+	const int32 NumClients = FMath::Max(TestContext.GetNumClients(), 1);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	for (const int32 ActorCount : Opts.ActorCounts)
+	{
+		while (Actors.Num() < ActorCount)
+		{
+			AUntestReplicationLoadActor* Actor = ServerWorld->SpawnActor<AUntestReplicationLoadActor>(SpawnParams);
+			if (Opts.bDormant)
+			{
+				Actor->SetNetDormancy(DORM_DormantAll);
+			}
+			Actors.Emplace(Actor);
+		}
+
+		// Spawning is a one-off burst, so only measure once every client has caught up
+		int32 WaitTicks = 0;
+		while (CountClientActors(TestContext) < ActorCount)
+		{
+			if (++WaitTicks > Opts.MaxSpawnWaitTicks)
+			{
+				TestContext.AddError(FString::Printf(TEXT("Clients didn't receive %d replication load actors within %d server ticks"), ActorCount, Opts.MaxSpawnWaitTicks));
+				co_return;
+			}
+			co_await Squid::Suspend();
+		}
+
+		for (int32 Tick = 0; Tick < Opts.WarmupTicks; ++Tick)
+		{
+			ChurnActors(Opts.ChurnPercent, Opts.bDormant);
+			co_await Squid::Suspend();
+		}
+
+		const FUntestNetStats StartStats = TestContext.GetNetStats();
+		const double StartReceiveSeconds = GetClientReceiveSeconds(TestContext);
+
+		for (int32 Tick = 0; Tick < Opts.MeasureTicks; ++Tick)
+		{
+			ChurnActors(Opts.ChurnPercent, Opts.bDormant);
+			co_await Squid::Suspend();
+		}
+
+		const FUntestNetStats& EndStats = TestContext.GetNetStats();
+		const int32 MeasuredTicks = FMath::Max(EndStats.Frames - StartStats.Frames, 1);
+		const double ReceiveMs = (GetClientReceiveSeconds(TestContext) - StartReceiveSeconds) * 1000.0;
+
+		const FString Prefix = FString::Printf(TEXT("ReplicationLoad.%d."), ActorCount);
+		TestContext.AddMetric(Prefix + TEXT("ServerReplicateMsPerTick"), (EndStats.ReplicateActorsMs - StartStats.ReplicateActorsMs) / MeasuredTicks);
+		TestContext.AddMetric(Prefix + TEXT("ClientReceiveMsPerTick"), ReceiveMs / MeasuredTicks / NumClients);
+		TestContext.AddMetric(Prefix + TEXT("OutBytesPerTick"), static_cast<double>(EndStats.OutBytes - StartStats.OutBytes) / MeasuredTicks);
+	}
+}
+
+void FUntestReplicationLoadFixture::ChurnActors(float ChurnPercent, bool bDormant)
+{
+	if (Actors.Num() == 0)
+	{
+		return;
+	}
+
+	// Round robin, so every actor changes at the same rate and the cost per tick is steady
+	const int32 NumToChurn = FMath::Min(FMath::CeilToInt32(Actors.Num() * ChurnPercent / 100.0f), Actors.Num());
+	for (int32 Index = 0; Index < NumToChurn; ++Index)
+	{
+		NextChurnIndex = (NextChurnIndex + 1) % Actors.Num();
+		if (AUntestReplicationLoadActor* Actor = Actors[NextChurnIndex].Get())
+		{
+			if (bDormant)
+			{
+				Actor->FlushNetDormancy();
+			}
+			Actor->Churn();
+		}
+	}
+}
+
+int32 FUntestReplicationLoadFixture::CountClientActors(FUntestContext& TestContext) const
+{
+	int32 MinActors = MAX_int32;
+	for (int32 ClientIndex = 0; ClientIndex < TestContext.GetNumClients(); ++ClientIndex)
+	{
+		int32 NumActors = 0;
+		if (UWorld* World = TestContext.GetWorld(static_cast<EUntestWorldType::Enum>(EUntestWorldType::Client + ClientIndex)))
+		{
+			for (TActorIterator<AUntestReplicationLoadActor> It(World); It; ++It)
+			{
+				++NumActors;
+			}
+		}
+		MinActors = FMath::Min(MinActors, NumActors);
+	}
+	return (MinActors == MAX_int32) ? 0 : MinActors;
+}
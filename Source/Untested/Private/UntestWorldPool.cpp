@@ -0,0 +1,824 @@
+#include "UntestWorldPool.h"
+#include "Untest.h"
+#include "UntestGarbageCollector.h"
+#include "UntestMapPreloader.h"
+
+#include "Engine/Engine.h"
+#include "Engine/LatentActionManager.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "EngineUtils.h"
+#include "GameFramework/WorldSettings.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "TimerManager.h"
+
+FUntestWorldPool& FUntestWorldPool::Get()
+{
+	static FUntestWorldPool Pool;
+	return Pool;
+}
+
+void FUntestWorldPool::SetEnabled(bool bInEnabled)
+{
+	bEnabled = bInEnabled;
+	if (bEnabled == false)
+	{
+		Empty();
+	}
+}
+
+bool FUntestWorldPool::Acquire(const FString& Key, EUntestWorldProfile Profile, const FString& MapPackageName, const FString& SnapshotKey, const FString& WorldName, FUntestPooledWorld& OutWorld, FString& OutError)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestWorldPool::Acquire);
+
+	const FString PoolKey = FString::Printf(TEXT("%s|%s|%s|%s"), *Key, UntestWorldProfileStr(Profile), *MapPackageName, *SnapshotKey);
+
+	if (bEnabled)
+	{
+		if (TArray<FUntestPooledWorld>* Worlds = FreeWorlds.Find(PoolKey))
+		{
+			while (Worlds->Num() > 0)
+			{
+				FUntestPooledWorld PooledWorld = Worlds->Pop(EAllowShrinking::No);
+				if (PooledWorld.World.IsValid() && PooledWorld.GameInstance.IsValid() && RestoreSnapshot(PooledWorld))
+				{
+					PooledWorld.LastTestName = WorldName;
+					InUseWorlds.Add(PooledWorld);
+					OutWorld = MoveTemp(PooledWorld);
+					return true;
+				}
+
+				// Something outside the pool destroyed part of this world or its snapshot, so it can't be reused
+				DestroyWorld(PooledWorld);
+			}
+		}
+	}
+
+	FUntestPooledWorld PooledWorld;
+	PooledWorld.Key = PoolKey;
+	PooledWorld.LastTestName = WorldName;
+	if (CreateWorld(WorldName, Profile, MapPackageName, PooledWorld, OutError) == false)
+	{
+		return false;
+	}
+
+	InUseWorlds.Add(PooledWorld);
+	OutWorld = MoveTemp(PooledWorld);
+	return true;
+}
+
+void FUntestWorldPool::Release(UWorld* World)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestWorldPool::Release);
+
+	FUntestPooledWorld PooledWorld;
+	if (RemoveInUse(World, PooledWorld) == false)
+	{
+		return;
+	}
+
+	TArray<FUntestPooledWorld>& Worlds = FreeWorlds.FindOrAdd(PooledWorld.Key);
+	if (bEnabled && Worlds.Num() < MaxFreeWorldsPerKey && ResetWorld(PooledWorld))
+	{
+		Worlds.Emplace(MoveTemp(PooledWorld));
+	}
+	else
+	{
+		DestroyWorld(PooledWorld);
+	}
+}
+
+void FUntestWorldPool::TakeSnapshot(UWorld* World)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestWorldPool::TakeSnapshot);
+
+	FUntestPooledWorld* PooledWorld = InUseWorlds.FindByPredicate([World](const FUntestPooledWorld& InUseWorld)
+		{
+			return InUseWorld.World.Get() == World;
+		});
+	if (PooledWorld == nullptr)
+	{
+		return;
+	}
+
+	TSharedRef<FUntestWorldSnapshot> Snapshot = MakeShared<FUntestWorldSnapshot>();
+	auto SaveProperties = [&Snapshot](UObject* Object)
+	{
+		FUntestWorldSnapshot::FObjectState& State = Snapshot->Objects.AddDefaulted_GetRef();
+		State.Object = Object;
+
+		// Object references are saved as paths, so ones that no longer resolve are restored as null instead of dangling.
+		// Every property is written, including ones still at their default, so restoring also undoes changes to those.
+		FMemoryWriter Writer(State.Properties, true /*bIsPersistent*/);
+		FObjectAndNameAsStringProxyArchive Ar(Writer, false /*bInLoadIfFindFails*/);
+		Ar.ArNoDelta = true;
+		Object->SerializeScriptProperties(Ar);
+	};
+
+	CaptureBaseline(*PooledWorld);
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		SaveProperties(*It);
+		for (UActorComponent* Component : It->GetComponents())
+		{
+			if (Component)
+			{
+				SaveProperties(Component);
+			}
+		}
+	}
+
+	PooledWorld->Snapshot = MoveTemp(Snapshot);
+}
+
+void FUntestWorldPool::Discard(UWorld* World)
+{
+	FUntestPooledWorld PooledWorld;
+	if (RemoveInUse(World, PooledWorld))
+	{
+		DestroyWorld(PooledWorld);
+	}
+}
+
+void FUntestWorldPool::Empty()
+{
+	for (auto& Pair : FreeWorlds)
+	{
+		for (FUntestPooledWorld& PooledWorld : Pair.Value)
+		{
+			DestroyWorld(PooledWorld);
+		}
+	}
+	FreeWorlds.Reset();
+}
+
+bool FUntestWorldPool::RemoveInUse(UWorld* World, FUntestPooledWorld& OutWorld)
+{
+	const int32 Index = InUseWorlds.IndexOfByPredicate([World](const FUntestPooledWorld& PooledWorld)
+		{
+			return PooledWorld.World.Get() == World;
+		});
+
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	OutWorld = MoveTemp(InUseWorlds[Index]);
+	InUseWorlds.RemoveAtSwap(Index, EAllowShrinking::No);
+	return true;
+}
+
+// Bare worlds are created as game previews, since world subsystems that don't opt into them aren't created for them
+static EWorldType::Type GetWorldType(EUntestWorldProfile Profile)
+{
+	return (Profile == EUntestWorldProfile::Bare) ? EWorldType::GamePreview : EWorldType::PIE;
+}
+
+static UWorld::InitializationValues GetInitializationValues(EUntestWorldProfile Profile)
+{
+	UWorld::InitializationValues Values;
+	if (Profile == EUntestWorldProfile::Full)
+	{
+		return Values;
+	}
+
+	Values.CreateNavigation(false)
+		.CreateAISystem(false)
+		.AllowAudioPlayback(false)
+		.CreateFXSystem(false)
+		.RequiresHitProxies(false)
+		.SetTransactional(false)
+		.CreateWorldPartition(false);
+
+	if (Profile == EUntestWorldProfile::Bare)
+	{
+		// Components only create render state and physics bodies when their world has the matching scene
+		Values.InitializeScenes(false)
+			.CreatePhysicsScene(false)
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(false);
+	}
+
+	return Values;
+}
+
+bool FUntestWorldPool::CreateWorld(const FString& WorldName, EUntestWorldProfile Profile, const FString& MapPackageName, FUntestPooledWorld& OutWorld, FString& OutError)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestWorldPool::CreateWorld);
+
+	const FString PackageName = FString::Printf(TEXT("/Untest/TestPackage_%s"), *WorldName);
+	UPackage* Package = NewObject<UPackage>(nullptr, *PackageName);
+	Package->AddToRoot();
+	Package->MarkAsFullyLoaded();
+	OutWorld.Package = Package;
+
+	const FString GameInstanceName = FString::Printf(TEXT("UntestGameInstance_%s"), *WorldName);
+
+	UUntestGameInstance* GameInstance = CastChecked<UUntestGameInstance>(NewObject<UUntestGameInstance>(GetTransientPackage(), *GameInstanceName));
+	OutWorld.GameInstance = GameInstance;
+
+	const bool bInformEngineOfWorld = false;
+	const bool bAddToRoot = false;
+	const bool bSkipInitWorld = true;
+	const FString FullWorldName = FString::Printf(TEXT("UntestWorld_%s"), *WorldName);
+	UWorld* World = UWorld::CreateWorld(GetWorldType(Profile), bInformEngineOfWorld, *FullWorldName, Package, bAddToRoot, ERHIFeatureLevel::Num, nullptr, bSkipInitWorld);
+	if (World == nullptr)
+	{
+		OutError = TEXT("Failed to create test world");
+		DestroyWorld(OutWorld);
+		return false;
+	}
+	OutWorld.World = World;
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.RunAsDedicated = true;
+	WorldContext.OwningGameInstance = GameInstance;
+	WorldContext.SetCurrentWorld(World);
+
+	GameInstance->SetWorldContext(&WorldContext);
+	GameInstance->Init();
+	GameInstance->ClearFlags(RF_Standalone);
+	GameInstance->AddToRoot();
+
+	World->SetGameInstance(GameInstance);
+	World->InitWorld(GetInitializationValues(Profile));
+	World->SetPlayInEditorInitialNetMode(NM_DedicatedServer);
+
+	// Loaded before the world begins play, so the map's actors are part of the baseline that's kept between tests
+	if (MapPackageName.IsEmpty() == false)
+	{
+		if (UntestLoadMapInstance(World, MapPackageName, FString()) == nullptr)
+		{
+			OutError = FString::Printf(TEXT("Failed to load map %s"), *MapPackageName);
+			DestroyWorld(OutWorld);
+			return false;
+		}
+		World->FlushLevelStreaming(EFlushLevelStreamingType::Full);
+	}
+
+	World->InitializeActorsForPlay(FURL());
+	if (IsValid(World->GetWorldSettings()))
+	{
+		// Need to do this manually since world doesn't have a game mode
+		World->GetWorldSettings()->NotifyBeginPlay();
+		World->GetWorldSettings()->NotifyMatchStarted();
+	}
+	World->BeginPlay();
+
+	CaptureBaseline(OutWorld);
+
+	return true;
+}
+
+void FUntestWorldPool::CaptureBaseline(FUntestPooledWorld& PooledWorld)
+{
+	PooledWorld.BaselineActors.Reset();
+	PooledWorld.BaselineComponents.Reset();
+	for (TActorIterator<AActor> It(PooledWorld.World.Get()); It; ++It)
+	{
+		PooledWorld.BaselineActors.Add(*It);
+		for (UActorComponent* Component : It->GetComponents())
+		{
+			PooledWorld.BaselineComponents.Add(Component);
+		}
+	}
+}
+
+bool FUntestWorldPool::ResetWorld(FUntestPooledWorld& PooledWorld)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestWorldPool::ResetWorld);
+
+	UWorld* World = PooledWorld.World.Get();
+	if (World == nullptr || World->bIsTearingDown)
+	{
+		return false;
+	}
+
+	TSet<AActor*> BaselineActors;
+	BaselineActors.Reserve(PooledWorld.BaselineActors.Num());
+	for (const TWeakObjectPtr<AActor>& ActorPtr : PooledWorld.BaselineActors)
+	{
+		AActor* Actor = ActorPtr.Get();
+		if (IsValid(Actor) == false)
+		{
+			// The test destroyed an actor that was part of the initial world, which can't be undone
+			return false;
+		}
+		BaselineActors.Add(Actor);
+	}
+
+	TSet<UActorComponent*> BaselineComponents;
+	BaselineComponents.Reserve(PooledWorld.BaselineComponents.Num());
+	for (const TWeakObjectPtr<UActorComponent>& ComponentPtr : PooledWorld.BaselineComponents)
+	{
+		BaselineComponents.Add(ComponentPtr.Get());
+	}
+
+	bool bDestroyedActors = false;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (BaselineActors.Contains(*It) == false)
+		{
+			It->Destroy();
+			bDestroyedActors = true;
+			continue;
+		}
+
+		// Timers and latent actions would otherwise fire during the next test
+		World->GetTimerManager().ClearAllTimersForObject(*It);
+		World->GetLatentActionManager().RemoveActionsForObject(*It);
+
+		TInlineComponentArray<UActorComponent*> Components(*It);
+		for (UActorComponent* Component : Components)
+		{
+			if (BaselineComponents.Contains(Component) == false)
+			{
+				Component->DestroyComponent();
+				bDestroyedActors = true;
+				continue;
+			}
+			World->GetTimerManager().ClearAllTimersForObject(Component);
+			World->GetLatentActionManager().RemoveActionsForObject(Component);
+		}
+	}
+	if (bDestroyedActors)
+	{
+		FUntestGarbageCollector::Get().AddUntrackedGarbage();
+	}
+
+	// The world keeps having begun play. Running BeginPlay() again would repeat every subsystem's OnWorldBeginPlay()
+	// and the physics scene's start, which aren't meant to run twice, and actors spawned by the next test begin play
+	// as they're spawned anyway.
+	World->TimeSeconds = 0.0;
+	World->UnpausedTimeSeconds = 0.0;
+	World->RealTimeSeconds = 0.0;
+	World->AudioTimeSeconds = 0.0;
+	World->DeltaTimeSeconds = 0.0f;
+
+	return true;
+}
+
+bool FUntestWorldPool::RestoreSnapshot(FUntestPooledWorld& PooledWorld)
+{
+	if (PooledWorld.Snapshot.IsValid() == false)
+	{
+		return true;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestWorldPool::RestoreSnapshot);
+
+	for (const FUntestWorldSnapshot::FObjectState& State : PooledWorld.Snapshot->Objects)
+	{
+		UObject* Object = State.Object.Get();
+		if (IsValid(Object) == false)
+		{
+			// The test destroyed an actor or component that Setup() created, which can't be undone
+			return false;
+		}
+
+		FMemoryReader Reader(State.Properties, true /*bIsPersistent*/);
+		FObjectAndNameAsStringProxyArchive Ar(Reader, false /*bInLoadIfFindFails*/);
+		Ar.ArNoDelta = true;
+		Object->SerializeScriptProperties(Ar);
+	}
+
+	// Restored relative transforms only take effect once the components' world transforms are recalculated
+	for (const TWeakObjectPtr<AActor>& ActorPtr : PooledWorld.BaselineActors)
+	{
+		if (USceneComponent* RootComponent = ActorPtr.IsValid() ? ActorPtr->GetRootComponent() : nullptr)
+		{
+			RootComponent->UpdateComponentToWorld(EUpdateTransformFlags::None, ETeleportType::ResetPhysics);
+		}
+	}
+
+	return true;
+}
+
+void FUntestWorldPool::DestroyWorld(FUntestPooledWorld& PooledWorld)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestWorldPool::DestroyWorld);
+
+	UntestDestroyWorld(PooledWorld.LastTestName, PooledWorld.World.Get(), PooledWorld.GameInstance.Get(), PooledWorld.Package.Get());
+
+	PooledWorld.World.Reset();
+	PooledWorld.GameInstance.Reset();
+	PooledWorld.Package.Reset();
+	PooledWorld.BaselineActors.Reset();
+	PooledWorld.BaselineComponents.Reset();
+	PooledWorld.Snapshot.Reset();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FUntestClientServerPool
+
+FUntestClientServerPool& FUntestClientServerPool::Get()
+{
+	static FUntestClientServerPool Pool;
+	return Pool;
+}
+
+void FUntestClientServerPool::SetEnabled(bool bInEnabled)
+{
+	bEnabled = bInEnabled;
+	if (bEnabled == false)
+	{
+		Empty();
+	}
+}
+
+bool FUntestClientServerPool::TryAcquire(const FString& Key, const FString& TestName, FUntestPooledClientServer& OutPair)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestClientServerPool::TryAcquire);
+
+	if (bEnabled == false)
+	{
+		return false;
+	}
+
+	TArray<FUntestPooledClientServer>* Pairs = FreePairs.Find(Key);
+	if (Pairs == nullptr)
+	{
+		return false;
+	}
+
+	while (Pairs->Num() > 0)
+	{
+		FUntestPooledClientServer Pair = Pairs->Pop(EAllowShrinking::No);
+		if (IsConnected(Pair))
+		{
+			Pair.LastTestName = TestName;
+			InUsePairs.Add(Pair);
+			OutPair = MoveTemp(Pair);
+			return true;
+		}
+
+		// The connection dropped while the pair was waiting in the pool
+		Destroy(Pair);
+	}
+
+	return false;
+}
+
+void FUntestClientServerPool::Add(FUntestPooledClientServer Pair)
+{
+	Pair.BaselineActors.SetNum(Pair.NumWorlds());
+	for (int32 WorldType = EUntestWorldType::Server; WorldType < Pair.NumWorlds(); ++WorldType)
+	{
+		Pair.BaselineActors[WorldType].Reset();
+		if (UWorld* World = Pair.Worlds[WorldType].Get())
+		{
+			for (TActorIterator<AActor> It(World); It; ++It)
+			{
+				Pair.BaselineActors[WorldType].Add(*It);
+			}
+		}
+	}
+
+	InUsePairs.Emplace(MoveTemp(Pair));
+}
+
+UntestTask FUntestClientServerPool::Release(UWorld* ServerWorld, FResetFunc ResetFunc)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestClientServerPool::Release);
+
+	const int32 Index = InUsePairs.IndexOfByPredicate([ServerWorld](const FUntestPooledClientServer& Pair)
+		{
+			return Pair.GetServerWorld() == ServerWorld;
+		});
+	if (Index == INDEX_NONE)
+	{
+		co_return;
+	}
+
+	// The pair stays in the in-use list while it's reset so it can still be discarded if the test is stopped
+	// partway through the reset
+	FUntestPooledClientServer Pair = InUsePairs[Index];
+
+	const TArray<FUntestPooledClientServer>* Pairs = FreePairs.Find(Pair.Key);
+	const bool bHasRoom = (Pairs == nullptr) || (Pairs->Num() < MaxFreePairsPerKey);
+
+	bool bKeep = false;
+	if (bEnabled && bHasRoom)
+	{
+		bKeep = co_await ResetPair(Pair, ResetFunc);
+	}
+
+	FUntestPooledClientServer ReleasedPair;
+	if (RemoveInUse(ServerWorld, ReleasedPair) == false)
+	{
+		co_return;
+	}
+
+	// Concurrently running tests may have filled the pool while this pair was being reset
+	TArray<FUntestPooledClientServer>& KeyPairs = FreePairs.FindOrAdd(ReleasedPair.Key);
+	if (bKeep && KeyPairs.Num() < MaxFreePairsPerKey)
+	{
+		KeyPairs.Emplace(MoveTemp(ReleasedPair));
+	}
+	else
+	{
+		Destroy(ReleasedPair);
+	}
+}
+
+bool FUntestClientServerPool::Discard(UWorld* ServerWorld)
+{
+	FUntestPooledClientServer Pair;
+	if (RemoveInUse(ServerWorld, Pair) == false)
+	{
+		return false;
+	}
+
+	Destroy(Pair);
+	return true;
+}
+
+void FUntestClientServerPool::Empty()
+{
+	TMap<FString, TArray<FUntestPooledClientServer>> PairsToDestroy = MoveTemp(FreePairs);
+	FreePairs.Reset();
+
+	for (auto& KeyPairs : PairsToDestroy)
+	{
+		for (FUntestPooledClientServer& Pair : KeyPairs.Value)
+		{
+			Destroy(Pair);
+		}
+	}
+}
+
+void FUntestClientServerPool::Destroy(FUntestPooledClientServer& Pair)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestClientServerPool::Destroy);
+
+	TArray<FName, TInlineAllocator<EUntestWorldType::Count>> PackageNames;
+
+	for (int32 WorldType = EUntestWorldType::Server; WorldType < Pair.NumWorlds(); ++WorldType)
+	{
+		UWorld* World = Pair.Worlds[WorldType].Get();
+		if (World)
+		{
+			// Maps streamed into the world are registered for remapping like the world's own package
+			for (const ULevelStreaming* StreamingLevel : World->GetStreamingLevels())
+			{
+				if (StreamingLevel)
+				{
+					PackageNames.Add(StreamingLevel->GetWorldAssetPackageFName());
+				}
+			}
+		}
+
+		UPackage* Package = Pair.Packages[WorldType].Get();
+		if (Package)
+		{
+			PackageNames.Add(Package->GetFName());
+		}
+
+		UntestDestroyWorld(Pair.LastTestName, World, Pair.GameInstances[WorldType].Get(), Package);
+	}
+
+	Pair.Worlds.Reset();
+	Pair.GameInstances.Reset();
+	Pair.Packages.Reset();
+	Pair.BaselineActors.Reset();
+
+	RemovePIEPackageNames(PackageNames);
+}
+
+Squid::Task<bool> FUntestClientServerPool::ResetPair(FUntestPooledClientServer& Pair, FResetFunc ResetFunc)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUntestClientServerPool::ResetPair);
+
+	if (IsConnected(Pair) == false || Pair.BaselineActors.Num() != Pair.NumWorlds())
+	{
+		co_return false;
+	}
+
+	TArray<TSet<AActor*>> BaselineActors;
+	BaselineActors.SetNum(Pair.NumWorlds());
+	for (int32 WorldType = EUntestWorldType::Server; WorldType < Pair.NumWorlds(); ++WorldType)
+	{
+		for (const TWeakObjectPtr<AActor>& ActorPtr : Pair.BaselineActors[WorldType])
+		{
+			AActor* Actor = ActorPtr.Get();
+			if (IsValid(Actor) == false)
+			{
+				// The test destroyed part of the connected game (e.g. a player controller), which can't be undone
+				co_return false;
+			}
+			BaselineActors[WorldType].Add(Actor);
+		}
+	}
+
+	// Destroying the server's copy of a replicated actor also destroys it on the clients once replication is flushed
+	// below, so only actors the clients spawned themselves need to be destroyed directly
+	bool bDestroyedActors = false;
+	for (int32 WorldType = EUntestWorldType::Server; WorldType < Pair.NumWorlds(); ++WorldType)
+	{
+		const bool bIsServer = (WorldType == EUntestWorldType::Server);
+		for (TActorIterator<AActor> It(Pair.Worlds[WorldType].Get()); It; ++It)
+		{
+			if (BaselineActors[WorldType].Contains(*It) == false && (bIsServer || It->GetLocalRole() == ROLE_Authority))
+			{
+				It->Destroy();
+				bDestroyedActors = true;
+			}
+		}
+	}
+	if (bDestroyedActors)
+	{
+		FUntestGarbageCollector::Get().AddUntrackedGarbage();
+	}
+
+	if (ResetFunc)
+	{
+		ResetFunc(Pair.GetServerWorld(), EUntestWorldType::Server);
+	}
+
+	auto HasTestActors = [&Pair, &BaselineActors]()
+	{
+		for (int32 WorldType = EUntestWorldType::Client; WorldType < Pair.NumWorlds(); ++WorldType)
+		{
+			for (TActorIterator<AActor> It(Pair.Worlds[WorldType].Get()); It; ++It)
+			{
+				if (BaselineActors[WorldType].Contains(*It) == false)
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	};
+
+	// Tick until the clients have received everything the server sent, so the next test doesn't see actors that are
+	// about to be destroyed or property updates from the previous test
+	const float DeltaSeconds = 1.0f / 60.0f;
+	const int32 MinFlushFrames = 2;
+	bool bFlushed = false;
+	for (int32 Frame = 0; Frame < MaxResetFlushFrames; ++Frame)
+	{
+		// Worlds can be torn down or disconnected while this is suspended, e.g. by the end of the test run
+		if (IsConnected(Pair) == false)
+		{
+			co_return false;
+		}
+
+		for (const TWeakObjectPtr<UWorld>& World : Pair.Worlds)
+		{
+			if (World.IsValid() == false)
+			{
+				co_return false;
+			}
+			World->Tick(LEVELTICK_All, DeltaSeconds);
+		}
+
+		if (Frame + 1 >= MinFlushFrames && HasTestActors() == false)
+		{
+			bFlushed = true;
+			break;
+		}
+
+		co_await Squid::Suspend();
+	}
+
+	if (bFlushed == false || IsConnected(Pair) == false)
+	{
+		co_return false;
+	}
+
+	if (ResetFunc)
+	{
+		for (int32 WorldType = EUntestWorldType::Client; WorldType < Pair.NumWorlds(); ++WorldType)
+		{
+			ResetFunc(Pair.Worlds[WorldType].Get(), static_cast<EUntestWorldType::Enum>(WorldType));
+		}
+	}
+
+	co_return true;
+}
+
+bool FUntestClientServerPool::IsConnected(const FUntestPooledClientServer& Pair)
+{
+	UWorld* ServerWorld = Pair.GetServerWorld();
+	if (ServerWorld == nullptr || ServerWorld->bIsTearingDown || Pair.NumWorlds() <= EUntestWorldType::Client)
+	{
+		return false;
+	}
+
+	const UNetDriver* ServerNetDriver = ServerWorld->GetNetDriver();
+	const int32 NumClients = Pair.NumWorlds() - EUntestWorldType::Client;
+	if (ServerNetDriver == nullptr || ServerNetDriver->ClientConnections.Num() < NumClients)
+	{
+		return false;
+	}
+
+	for (int32 WorldType = EUntestWorldType::Client; WorldType < Pair.NumWorlds(); ++WorldType)
+	{
+		UWorld* ClientWorld = Pair.Worlds[WorldType].Get();
+		if (ClientWorld == nullptr || ClientWorld->bIsTearingDown)
+		{
+			return false;
+		}
+
+		const UNetDriver* ClientNetDriver = ClientWorld->GetNetDriver();
+		if (ClientNetDriver == nullptr || ClientNetDriver->ServerConnection == nullptr || ClientNetDriver->ServerConnection->GetConnectionState() != USOCK_Open)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FUntestClientServerPool::RemoveInUse(UWorld* ServerWorld, FUntestPooledClientServer& OutPair)
+{
+	const int32 Index = InUsePairs.IndexOfByPredicate([ServerWorld](const FUntestPooledClientServer& Pair)
+		{
+			return Pair.GetServerWorld() == ServerWorld;
+		});
+
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	OutPair = MoveTemp(InUsePairs[Index]);
+	InUsePairs.RemoveAtSwap(Index, EAllowShrinking::No);
+	return true;
+}
+
+void FUntestClientServerPool::AddPIEPackageName(FName PackageName)
+{
+	int32& RefCount = PIEPackageNames.FindOrAdd(PackageName);
+	if (RefCount++ == 0)
+	{
+		FSoftObjectPath::AddPIEPackageName(PackageName);
+	}
+}
+
+void FUntestClientServerPool::RemovePIEPackageNames(TArrayView<const FName> PackageNames)
+{
+	bool bRemovedAny = false;
+	for (const FName& PackageName : PackageNames)
+	{
+		int32* RefCount = PIEPackageNames.Find(PackageName);
+		if (RefCount && --(*RefCount) <= 0)
+		{
+			PIEPackageNames.Remove(PackageName);
+			bRemovedAny = true;
+		}
+	}
+
+	if (bRemovedAny)
+	{
+		FSoftObjectPath::ClearPIEPackageNames();
+		for (const auto& NameRefCount : PIEPackageNames)
+		{
+			FSoftObjectPath::AddPIEPackageName(NameRefCount.Key);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// UntestDestroyWorld
+
+void UntestDestroyWorld(const FString& TestName, UWorld* World, UGameInstance* GameInstance, UPackage* Package)
+{
+	FUntestGarbageCollector& GarbageCollector = FUntestGarbageCollector::Get();
+	GarbageCollector.ExpectCollected(TestName, World);
+	GarbageCollector.ExpectCollected(TestName, GameInstance);
+	GarbageCollector.ExpectCollected(TestName, Package);
+
+	// See https://minifloppy.it/posts/2024/automated-testing-specs-ue5/#uworld-fixture
+	if (World)
+	{
+		World->BeginTearingDown();
+
+		// DestroyWorld doesn't do this and instead waits for GC to clear everything up
+		for (auto It = TActorIterator<AActor>(World); It; ++It)
+		{
+			It->Destroy();
+		}
+
+		GEngine->DestroyWorldContext(World);
+		World->RemoveFromRoot();
+		World->DestroyWorld(false /*bInformEngineOfWorld*/);
+	}
+
+	if (GameInstance)
+	{
+		GameInstance->Shutdown();
+		GameInstance->RemoveFromRoot();
+		GameInstance->ConditionalBeginDestroy();
+	}
+
+	if (Package)
+	{
+		Package->RemoveFromRoot();
+		Package->ConditionalBeginDestroy();
+	}
+}
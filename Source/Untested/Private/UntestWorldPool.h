@@ -0,0 +1,168 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Untest.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class AActor;
+class UActorComponent;
+class UGameInstance;
+class UPackage;
+class UWorld;
+
+// The property values of every actor and component in a world, saved once a fixture's Setup() has finished
+struct FUntestWorldSnapshot
+{
+	struct FObjectState
+	{
+		TWeakObjectPtr<UObject> Object;
+		TArray<uint8> Properties;
+	};
+
+	TArray<FObjectState> Objects;
+};
+
+// A world created for a World test, along with the objects that own it.
+struct FUntestPooledWorld
+{
+	FString Key;
+	FString LastTestName; // Leaks found once the world is destroyed are reported against this test
+	TWeakObjectPtr<UPackage> Package;
+	TWeakObjectPtr<UGameInstance> GameInstance;
+	TWeakObjectPtr<UWorld> World;
+
+	// Actors that existed once the world began play, and their components. Everything else is destroyed when the world
+	// is reset.
+	TArray<TWeakObjectPtr<AActor>> BaselineActors;
+	TArray<TWeakObjectPtr<UActorComponent>> BaselineComponents;
+
+	// Set once a fixture with a snapshot key has finished Setup() in this world. Worlds handed out with a snapshot have
+	// been restored to it, so their fixture doesn't run Setup() again.
+	TSharedPtr<const FUntestWorldSnapshot> Snapshot;
+};
+
+// Creating and destroying a world usually costs far more than the World test that uses it, so World fixtures
+// get their worlds from this pool. Released worlds are reset and handed to the next test with the same key instead of
+// being destroyed: spawned actors and components added to baseline actors are destroyed, timers and latent actions of
+// baseline actors are cleared and time is reset. The world stays begun, so BeginPlay isn't run again, and property
+// changes to baseline actors, e.g. the world settings, carry over to the next test unless the fixture snapshots them.
+class FUntestWorldPool
+{
+public:
+	static FUntestWorldPool& Get();
+
+	// When disabled, every Acquire() creates a new world and every Release() destroys it
+	void SetEnabled(bool bInEnabled);
+	bool IsEnabled() const { return bEnabled; }
+
+	// Reuses a free world with a matching key, profile, map and snapshot key, or creates a new one. New worlds load
+	// their map synchronously, so it should already be in memory from FUntestMapPreloader.
+	bool Acquire(const FString& Key, EUntestWorldProfile Profile, const FString& MapPackageName, const FString& SnapshotKey, const FString& WorldName, FUntestPooledWorld& OutWorld, FString& OutError);
+
+	// Saves the state of an in-use world after its fixture's Setup(). Every actor now in the world is kept when the world
+	// is reset, and restored to the saved state before the world is handed out again.
+	void TakeSnapshot(UWorld* World);
+
+	// Resets the world and keeps it for reuse. Worlds that fail to reset or don't fit in the pool are destroyed.
+	void Release(UWorld* World);
+
+	// Destroys the world without reusing it. Use when a test didn't get a chance to finish cleanly.
+	void Discard(UWorld* World);
+
+	// Destroys all free worlds. Called at the end of every test run so pooled worlds don't outlive it.
+	void Empty();
+
+private:
+	static bool CreateWorld(const FString& WorldName, EUntestWorldProfile Profile, const FString& MapPackageName, FUntestPooledWorld& OutWorld, FString& OutError);
+	static void CaptureBaseline(FUntestPooledWorld& PooledWorld);
+	static bool ResetWorld(FUntestPooledWorld& PooledWorld);
+	static bool RestoreSnapshot(FUntestPooledWorld& PooledWorld);
+	static void DestroyWorld(FUntestPooledWorld& PooledWorld);
+
+	bool RemoveInUse(UWorld* World, FUntestPooledWorld& OutWorld);
+
+	static constexpr int32 MaxFreeWorldsPerKey = 2;
+
+	bool bEnabled = true;
+	TMap<FString, TArray<FUntestPooledWorld>> FreeWorlds;
+	TArray<FUntestPooledWorld> InUseWorlds;
+};
+
+// A server world and its connected client worlds, created for a ClientServer test. Indexed by EUntestWorldType, with
+// one entry per client.
+struct FUntestPooledClientServer
+{
+	FString Key;
+	FString LastTestName; // Leaks found once the pair is destroyed are reported against this test
+	TArray<TWeakObjectPtr<UPackage>> Packages;
+	TArray<TWeakObjectPtr<UGameInstance>> GameInstances;
+	TArray<TWeakObjectPtr<UWorld>> Worlds;
+
+	// Actors that existed once the clients finished joining (game mode, game state, player controllers, pawns, ...).
+	// Everything else is destroyed when the pair is reset.
+	TArray<TArray<TWeakObjectPtr<AActor>>> BaselineActors;
+
+	int32 NumWorlds() const { return Worlds.Num(); }
+	UWorld* GetServerWorld() const { return Worlds.IsValidIndex(EUntestWorldType::Server) ? Worlds[EUntestWorldType::Server].Get() : nullptr; }
+};
+
+// Most of the cost of a ClientServer test is creating both worlds, completing the network handshake and collecting
+// garbage afterwards. ClientServer fixtures hand their connected pairs to this pool, which resets gameplay state
+// between tests but keeps the NetDriver connection alive so the next test with the same key can start immediately.
+class FUntestClientServerPool
+{
+public:
+	using FResetFunc = TFunction<void(UWorld*, const EUntestWorldType::Enum)>;
+
+	static FUntestClientServerPool& Get();
+
+	// When disabled, pairs are destroyed as soon as they are released
+	void SetEnabled(bool bInEnabled);
+	bool IsEnabled() const { return bEnabled; }
+
+	// Hands out a free, still connected pair with a matching key
+	bool TryAcquire(const FString& Key, const FString& TestName, FUntestPooledClientServer& OutPair);
+
+	// Starts tracking a newly connected pair as in use. The actors currently in both worlds become its baseline.
+	void Add(FUntestPooledClientServer Pair);
+
+	// Resets the pair and keeps it for reuse, destroying it instead if the reset fails. ResetFunc is called for the
+	// server before pending replication is flushed to the client, and for the client afterwards.
+	UntestTask Release(UWorld* ServerWorld, FResetFunc ResetFunc);
+
+	// Destroys the pair without reusing it. Returns false if the pool doesn't own a pair with this server world.
+	bool Discard(UWorld* ServerWorld);
+
+	// Destroys all free pairs. Called at the end of every test run so pooled pairs don't outlive it.
+	void Empty();
+
+	// Destroys a pair's worlds, game instances and packages. Garbage is collected later by FUntestGarbageCollector.
+	void Destroy(FUntestPooledClientServer& Pair);
+
+	// The PIE package name list used to remap package names for replication is global, and FSoftObjectPath can only
+	// clear all of it at once. Names are reference counted here so destroying one pair only removes that pair's names
+	// and leaves those of pairs still running in other tests alone.
+	void AddPIEPackageName(FName PackageName);
+	void RemovePIEPackageNames(TArrayView<const FName> PackageNames);
+
+	// Keeps up to this many free pairs per key, so tests that ran concurrently can all reuse a pair afterwards
+	void SetMaxFreePairsPerKey(int32 InMaxFreePairsPerKey) { MaxFreePairsPerKey = FMath::Max(InMaxFreePairsPerKey, 1); }
+
+private:
+	static Squid::Task<bool> ResetPair(FUntestPooledClientServer& Pair, FResetFunc ResetFunc);
+	static bool IsConnected(const FUntestPooledClientServer& Pair);
+
+	bool RemoveInUse(UWorld* ServerWorld, FUntestPooledClientServer& OutPair);
+
+	static constexpr int32 MaxResetFlushFrames = 30;
+
+	bool bEnabled = true;
+	int32 MaxFreePairsPerKey = 1;
+	TMap<FName, int32> PIEPackageNames;
+	TMap<FString, TArray<FUntestPooledClientServer>> FreePairs;
+	TArray<FUntestPooledClientServer> InUsePairs;
+};
+
+// Tears down a test world and the game instance and package that own it, for FUntestGarbageCollector to collect and
+// report as leaked by TestName if they survive. Any of them may be null.
+void UntestDestroyWorld(const FString& TestName, UWorld* World, UGameInstance* GameInstance, UPackage* Package);
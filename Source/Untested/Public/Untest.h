@@ -4,7 +4,6 @@
 #error Untest code not enabled in non-editor builds.
 #endif
 
-#include "Containers/StaticArray.h"
 #include "Engine/GameInstance.h"
 #include "SquidTasks/Task.h"
 #include "UObject/Package.h"
@@ -51,8 +50,15 @@ struct FUntestOpts
 
 	bool IsSet(EUntestFlags InFlags) const { return (Flags & InFlags) != EUntestFlags::None; }
 
+	FUntestOpts& SetMap(const TCHAR* InMapPackageName)
+	{
+		MapPackageName = InMapPackageName;
+		return *this;
+	}
+
 	float TimeoutMs;
 	EUntestFlags Flags;
+	FString MapPackageName; // World and ClientServer tests only. Long package name of a map to load into the test's worlds.
 };
 
 using UntestTask = Squid::Task<>;
@@ -71,10 +77,13 @@ public:
 
 struct FUntestFixture;
 struct FUntestLineContext;
+class FUntestReplicationAuditor;
 
 namespace EUntestWorldType
 {
-	enum Enum
+	// Multi-client fixtures number their clients upwards from Client, so the Nth client is Client + N. Count is the
+	// number of worlds in a regular ClientServer test.
+	enum Enum : int32
 	{
 		Server,
 		Client,
@@ -82,6 +91,78 @@ namespace EUntestWorldType
 	};
 } // namespace EUntestWorldType
 
+// A named measurement recorded by a test or fixture, written to the test report alongside the test's timings.
+// Names should include the unit, e.g. "ServerTickMs.Avg".
+struct FUntestMetric
+{
+	FString Name;
+	double Value = 0.0;
+};
+
+// Network traffic and replication work for a ClientServer test, measured on the server's NetDriver while the test runs.
+// Setup and the reset of pooled server/client pairs aren't included. Out is server to clients, In is clients to server.
+struct FUntestNetStats
+{
+	int32 Frames = 0;
+	double DurationSeconds = 0.0;
+
+	uint64 OutBytes = 0;
+	uint64 InBytes = 0;
+	uint64 OutPackets = 0;
+	uint64 InPackets = 0;
+	uint64 OutBunches = 0;
+	uint64 InBunches = 0;
+
+	// Only recorded when the test uses the default loopback NetDriver
+	uint64 OutRPCs = 0;
+	uint64 InRPCs = 0;
+	uint64 ReplicatedActors = 0; // Summed over every frame's ServerReplicateActors(). Always 0 with Iris.
+	int32 MaxReplicatedActorsPerFrame = 0;
+	double ReplicateActorsMs = 0.0; // Time spent in ServerReplicateActors(), or with Iris in the server NetDriver's TickFlush()
+	double MaxReplicateActorsMsPerFrame = 0.0;
+
+	// Round trip times measured by the clients' connections, once they've measured any
+	double AvgRttMs = 0.0;
+	double MaxRttMs = 0.0;
+	int32 RttSamples = 0;
+
+	bool IsValid() const { return Frames > 0; }
+	double GetOutBytesPerSecond() const { return (DurationSeconds > 0.0) ? OutBytes / DurationSeconds : 0.0; }
+	double GetInBytesPerSecond() const { return (DurationSeconds > 0.0) ? InBytes / DurationSeconds : 0.0; }
+	double GetAvgReplicatedActorsPerFrame() const { return (Frames > 0) ? static_cast<double>(ReplicatedActors) / Frames : 0.0; }
+	double GetAvgReplicateActorsMsPerFrame() const { return (Frames > 0) ? ReplicateActorsMs / Frames : 0.0; }
+};
+
+// Simulated network conditions for ClientServer tests. Applied to the packets sent by the server and by every client
+// once they're connected, so test setup isn't slowed down by them.
+struct FUntestNetProfile
+{
+	int32 LatencyMs = 0;		// Added in each direction, so the round trip grows by twice this
+	int32 JitterMs = 0;			// Up to this much random extra latency per packet
+	int32 LossPercent = 0;		// Packets dropped instead of sent
+	int32 DuplicatePercent = 0; // Packets sent twice
+	int32 ReorderPercent = 0;	// Packets held back until after the next one. NetDrivers other than the loopback one can only turn reordering on or off.
+
+	bool IsActive() const { return LatencyMs > 0 || JitterMs > 0 || LossPercent > 0 || DuplicatePercent > 0 || ReorderPercent > 0; }
+};
+
+// Replication system the NetDrivers of a ClientServer test were created with
+enum class EUntestReplicationSystem : uint32
+{
+	Default, // Whatever the project's net.Iris.UseIrisReplication setting picks
+	Generic,
+	Iris,
+};
+
+UNTESTED_API const TCHAR* UntestReplicationSystemStr(EUntestReplicationSystem System);
+
+// Time from marking a send with FUntestContext::MarkLatencySend() to its arrival being noticed by WaitForLatency()
+struct FUntestLatency
+{
+	int64 Ticks = 0; // Frames ticked by the fixture in between
+	double Ms = 0.0;
+};
+
 struct UNTESTED_API FUntestName
 {
 	FString Module;
@@ -92,11 +173,22 @@ struct UNTESTED_API FUntestName
 	{
 		return FString::Printf(TEXT("%s.%s.%s"), *Module, *Category, *Test);
 	}
+
+	// Module.Category, the name of the suite the test belongs to
+	FString ToSuite() const
+	{
+		return FString::Printf(TEXT("%s.%s"), *Module, *Category);
+	}
 };
 
+struct FUntestSuite;
+struct FUntestDedicatedServerTestFixture;
+
 struct UNTESTED_API FUntestContext
 {
 public:
+	FUntestContext() { SetNumWorlds(EUntestWorldType::Count); }
+
 	const FUntestName& GetName() const { return TestName; }
 
 	void AddError(FString Error);
@@ -131,9 +223,48 @@ public:
 
 	UGameInstance* GetGameInstance(EUntestWorldType::Enum Type);
 	UWorld* GetWorld(EUntestWorldType::Enum Type);
+	int32 GetNumClients() const { return FMath::Max(Worlds.Num() - EUntestWorldType::Client, 0); }
+
+	// Records a measurement for the report. Adding a metric with an existing name replaces its value.
+	void AddMetric(const FString& Name, double Value);
+	const TArray<FUntestMetric>& GetMetrics() const { return Metrics; }
+
+	// ClientServer tests only. Updated every frame while the test runs.
+	const FUntestNetStats& GetNetStats() const { return NetStats; }
+
+	// ClientServer tests only. Changes the simulated network conditions for the rest of the test. The fixture's
+	// GetNetProfile() is applied before the test starts.
+	void SetNetProfile(const FUntestNetProfile& Profile);
+	const FUntestNetProfile& GetNetProfile() const { return NetProfile; }
+
+	// ClientServer tests only. Generic or Iris when the run compares replication systems, for tests whose expectations differ.
+	EUntestReplicationSystem GetReplicationSystem() const { return ReplicationSystem; }
+
+	// ClientServer tests only. Null unless the fixture enables the audit in GetReplicationAuditOpts().
+	const FUntestReplicationAuditor* GetReplicationAuditor() const { return ReplicationAuditor.Get(); }
+
+	// Number of frames the World or ClientServer fixture has ticked since the test started running
+	int64 GetFrameNumber() const { return FrameNumber; }
+
+	// World and ClientServer tests only. The map from UNTEST_MAP() that was loaded into the test's worlds, if any.
+	const FString& GetMapPackageName() const { return MapPackageName; }
+
+	// The suite declared with UNTEST_SUITE() for this test's Module.Category, if any. Set up before the test starts.
+	template <typename T>
+	T* GetSuite() const { return static_cast<T*>(Suite.Get()); }
+
+	// Latency measurement for RPCs and replication. Call MarkLatencySend() right before sending an RPC or changing a
+	// replicated property, then co_await WaitForLatency() with the same key and a condition that becomes true once it
+	// arrived, usually from the other world's Run(). Arrival is checked once per frame after the world ticks, so the
+	// result is as precise as the frame rate. Every measurement is also aggregated into Latency.<Key>.* metrics.
+	void MarkLatencySend(const FString& Key);
+	Squid::Task<FUntestLatency> WaitForLatency(FString Key, TFunction<bool()> HasArrived);
 
 private:
+	void SetNumWorlds(int32 NumWorlds);
+
 	FUntestName TestName;
+	EUntestTypeFlags TestType = EUntestTypeFlags::None;
 	double TimeoutMs = 0.0;
 
 	FUntestFixture* Fixture = nullptr;
@@ -141,18 +272,48 @@ private:
 	TUniquePtr<Squid::TaskManager> TaskManager;
 	double TimestampBegin = 0.0;
 	double TimestampEnd = 0.0;
+	double CpuTimeMs = 0.0; // Thread CPU time spent while the test's coroutine was actively resumed
+	Squid::WeakTaskHandle RunAfterTask; // Pipelined tests only: the test that has to finish before this one runs
+	bool bWaitingToRun = false;			// Waiting for RunAfterTask or the suite's setup. Doesn't count against the timeout.
+	TSharedPtr<FUntestSuite> Suite;
 	TArray<FString> Errors;
+	TArray<FUntestMetric> Metrics;
+	FUntestNetStats NetStats;
+	FUntestNetProfile NetProfile;
+	EUntestReplicationSystem ReplicationSystem = EUntestReplicationSystem::Default;
+	TSharedPtr<FUntestReplicationAuditor> ReplicationAuditor;
+	int64 FrameNumber = 0;
+	FString MapPackageName;
+
+	struct FLatencySend
+	{
+		int64 FrameNumber = 0;
+		double Timestamp = 0.0;
+	};
+	struct FLatencyStats
+	{
+		int32 Count = 0;
+		double TotalMs = 0.0;
+		double MinMs = 0.0;
+		double MaxMs = 0.0;
+		int64 TotalTicks = 0;
+		int64 MaxTicks = 0;
+	};
+	TMap<FString, FLatencySend> LatencySends;
+	TMap<FString, FLatencyStats> LatencyStats;
 
-	// Only used for World and ClientServer tests
-	TStaticArray<TWeakObjectPtr<UPackage>, EUntestWorldType::Count> Packages;
-	TStaticArray<TWeakObjectPtr<UGameInstance>, EUntestWorldType::Count> GameInstances;
-	TStaticArray<TWeakObjectPtr<UWorld>, EUntestWorldType::Count> Worlds;
+	// Only used for World and ClientServer tests. Indexed by EUntestWorldType, with one entry per client.
+	TArray<TWeakObjectPtr<UPackage>> Packages;
+	TArray<TWeakObjectPtr<UGameInstance>> GameInstances;
+	TArray<TWeakObjectPtr<UWorld>> Worlds;
 	TArray<TWeakObjectPtr<UObject>> Objects;
 
 	friend class FUntestModule;
 	friend struct FUntestFixture;
 	friend struct FBVWorldTestFixture;
 	friend struct FBVClientServerTestFixture;
+	friend struct FUntestReplayTestFixture;
+	friend struct FUntestDedicatedServerTestFixture;
 };
 
 struct UNTESTED_API FUntestFixtureFactory
@@ -182,6 +343,66 @@ public:
 	virtual TSharedPtr<FUntestFixture> New(const TSharedPtr<FUntestContext>& FixtureContext) const override;
 };
 
+// State shared by every test in a Module.Category, e.g. a loaded dataset or spawned actors, declared with
+// UNTEST_SUITE(). Tests are scheduled so each category's tests run back to back. The suite is created and set up before
+// the first of them starts, and torn down once the last one has finished.
+struct UNTESTED_API FUntestSuite
+{
+public:
+	virtual ~FUntestSuite() = default;
+
+	// Runs within the first test of the suite, before its fixture is set up, and doesn't count against its duration or
+	// timeout. Errors added to TestContext fail that test, and the suite's other tests fail without running.
+	virtual UntestTask Setup(FUntestContext& TestContext);
+
+	// Setup() fails the suite once it has run for longer than this. <= 0 uses the timeout of the test it runs in.
+	// Scaled like test timeouts.
+	virtual float GetSetupTimeoutMs() const { return 0.0f; }
+
+	// Called once the suite's last test has finished, or been stopped
+	virtual void Teardown();
+
+private:
+	enum class EState : uint8
+	{
+		New,
+		SettingUp,
+		Ready,
+		Failed,
+	};
+
+	EState State = EState::New;
+	FString SetupTestName; // The test Setup() ran in, for the errors of the suite's other tests if it failed
+
+	friend class FUntestModule;
+};
+
+struct UNTESTED_API FUntestSuiteFactory
+{
+public:
+	FUntestSuiteFactory(FString InModuleName, FString InCategoryName);
+	virtual ~FUntestSuiteFactory();
+
+	const FString& GetName() const { return Name; }
+
+	virtual TSharedPtr<FUntestSuite> New() const = 0;
+
+private:
+	FString Name; // Module.Category
+};
+
+template <typename T>
+struct TUntestSuiteFactory : public FUntestSuiteFactory
+{
+public:
+	TUntestSuiteFactory(FString InModuleName, FString InCategoryName)
+		: FUntestSuiteFactory(InModuleName, InCategoryName)
+	{
+	}
+
+	virtual TSharedPtr<FUntestSuite> New() const override { return MakeShared<T>(); }
+};
+
 struct FUntestLineContext
 {
 	FUntestLineContext(const TCHAR* InFile, int32 InLine, const TCHAR* InLhs, const TCHAR* InRhs, bool bInIsAssert)
@@ -528,12 +749,31 @@ bool FUntestContext::IsInvalid(const FUntestLineContext& LineContext, const T& A
 
 inline UGameInstance* FUntestContext::GetGameInstance(EUntestWorldType::Enum Type)
 {
-	return GameInstances[static_cast<int32>(Type)].Get();
+	return GameInstances.IsValidIndex(Type) ? GameInstances[Type].Get() : nullptr;
 }
 
 inline UWorld* FUntestContext::GetWorld(EUntestWorldType::Enum Type)
 {
-	return Worlds[static_cast<int32>(Type)].Get();
+	return Worlds.IsValidIndex(Type) ? Worlds[Type].Get() : nullptr;
+}
+
+inline void FUntestContext::AddMetric(const FString& Name, double Value)
+{
+	if (FUntestMetric* Metric = Metrics.FindByPredicate([&Name](const FUntestMetric& Metric) { return Metric.Name == Name; }))
+	{
+		Metric->Value = Value;
+	}
+	else
+	{
+		Metrics.Emplace(FUntestMetric{ Name, Value });
+	}
+}
+
+inline void FUntestContext::SetNumWorlds(int32 NumWorlds)
+{
+	Packages.SetNum(NumWorlds);
+	GameInstances.SetNum(NumWorlds);
+	Worlds.SetNum(NumWorlds);
 }
 
 #define UNTEST_IMPL_NAME(Module, Category, TestName, FixtureType) Module##Category##TestName##_TestFixture
@@ -571,6 +811,11 @@ inline UWorld* FUntestContext::GetWorld(EUntestWorldType::Enum Type)
 			TEXT(#Module), TEXT(#Category), TEXT(#TestName), FixtureType::TestType(), FixtureType::DefaultTimeoutMs(), Opts);                                      \
 	UntestTask UNTEST_IMPL_NAME(Module, Category, TestName, _TestFixture)::Run(FUntestContext& TestContext, const EUntestWorldType::Enum _WorldType)
 
+// Declares the suite shared by the tests of Module.Category, see FUntestSuite
+#define UNTEST_SUITE(SuiteType, Module, Category)                                                                                   \
+	static_assert(TIsDerivedFrom<SuiteType, FUntestSuite>::IsDerived, "Only suites inheriting from FUntestSuite are allowed");      \
+	TUntestSuiteFactory<SuiteType> Module##Category##_SuiteFactory = TUntestSuiteFactory<SuiteType>(TEXT(#Module), TEXT(#Category))
+
 #define UNTEST_LINE_CONTEXT(A, B, bIsAssert) (FUntestLineContext(TEXT(__FILE__), __LINE__, TEXT(A), TEXT(B), bIsAssert))
 #define UNTEST_LINE_CONTEXT_EXPECT(A, B) UNTEST_LINE_CONTEXT(A, B, false)
 #define UNTEST_LINE_CONTEXT_ASSERT(A, B) UNTEST_LINE_CONTEXT(A, B, true)
@@ -583,6 +828,11 @@ inline UWorld* FUntestContext::GetWorld(EUntestWorldType::Enum Type)
 #define UNTEST_DISABLED() (FUntestOpts(EUntestFlags::Disabled))
 #define UNTEST_PURE() (FUntestOpts(EUntestFlags::Pure))
 
+// Loads a map into the test's worlds before Setup(), e.g. UNTEST_MAP("/Game/Maps/TestArena"). Queued tests have their
+// maps loaded in the background while earlier tests run, and pooled worlds are only reused by tests with the same map.
+#define UNTEST_MAP(MapPackageName) (FUntestOpts().SetMap(TEXT(MapPackageName)))
+#define UNTEST_TIMEOUTMS_MAP(DurationMs, MapPackageName) (FUntestOpts(static_cast<float>(DurationMs)).SetMap(TEXT(MapPackageName)))
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Declare tests using these macros.
 // For example:
@@ -600,6 +850,17 @@ inline UWorld* FUntestContext::GetWorld(EUntestWorldType::Enum Type)
 //     EXPECT_NE(UNTEST_GET_WORLD(), nullptr);
 //     co_return;
 // }
+//
+// Tests in the same suite can share state that's only set up once for all of them:
+//
+// struct FMySuite : public FUntestSuite { ... };
+// UNTEST_SUITE(FMySuite, ModuleName, SuiteName);
+//
+// UNTEST_UNIT(ModuleName, SuiteName, TestName)
+// {
+//     FMySuite* Suite = TestContext.GetSuite<FMySuite>();
+//     ...
+// }
 
 #define UNTEST_UNIT(Module, Category, TestName) UNTEST_UNIT_IMPL_FIXTURE(Module, Category, TestName, FBVUnitTestFixture, FUntestOpts())
 #define UNTEST_UNIT_OPTS(Module, Category, TestName, Opts) UNTEST_UNIT_IMPL_FIXTURE(Module, Category, TestName, FBVUnitTestFixture, Opts)
@@ -667,8 +928,26 @@ inline UWorld* FUntestContext::GetWorld(EUntestWorldType::Enum Type)
 
 #define UNTEST_GET_GAMEINSTANCE() (TestContext.GetGameInstance(_WorldType))
 #define UNTEST_GET_WORLD() (TestContext.GetWorld(_WorldType))
-#define UNTEST_IS_CLIENT() (_WorldType == EUntestWorldType::Client)
+#define UNTEST_IS_CLIENT() (_WorldType >= EUntestWorldType::Client)
 #define UNTEST_IS_SERVER() (_WorldType == EUntestWorldType::Server)
+#define UNTEST_CLIENT_INDEX() (static_cast<int32>(_WorldType) - EUntestWorldType::Client) // 0 for the first client, only valid on clients
+#define UNTEST_NUM_CLIENTS() (TestContext.GetNumClients())
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Network budgets for ClientServer tests. These check what the server has measured since the test started running,
+// so put them after the part of the test being budgeted.
+
+// clang-format off
+#define UNTEST_EXPECT_NET_OUT_BYTES_PER_SEC_LE(Budget) (void)TestContext.Le(UNTEST_LINE_CONTEXT_EXPECT("NetStats.OutBytesPerSec", #Budget), TestContext.GetNetStats().GetOutBytesPerSecond(), static_cast<double>(Budget))
+#define UNTEST_EXPECT_NET_IN_BYTES_PER_SEC_LE(Budget) (void)TestContext.Le(UNTEST_LINE_CONTEXT_EXPECT("NetStats.InBytesPerSec", #Budget), TestContext.GetNetStats().GetInBytesPerSecond(), static_cast<double>(Budget))
+#define UNTEST_EXPECT_NET_ACTORS_PER_FRAME_LE(Budget) (void)TestContext.Le(UNTEST_LINE_CONTEXT_EXPECT("NetStats.MaxReplicatedActorsPerFrame", #Budget), TestContext.GetNetStats().MaxReplicatedActorsPerFrame, static_cast<int32>(Budget))
+#define UNTEST_EXPECT_NET_REPLICATE_MS_PER_FRAME_LE(Budget) (void)TestContext.Le(UNTEST_LINE_CONTEXT_EXPECT("NetStats.MaxReplicateActorsMsPerFrame", #Budget), TestContext.GetNetStats().MaxReplicateActorsMsPerFrame, static_cast<double>(Budget))
+
+#define UNTEST_ASSERT_NET_OUT_BYTES_PER_SEC_LE(Budget) do { if (!TestContext.Le(UNTEST_LINE_CONTEXT_ASSERT("NetStats.OutBytesPerSec", #Budget), TestContext.GetNetStats().GetOutBytesPerSecond(), static_cast<double>(Budget))) co_return; } while (0)
+#define UNTEST_ASSERT_NET_IN_BYTES_PER_SEC_LE(Budget) do { if (!TestContext.Le(UNTEST_LINE_CONTEXT_ASSERT("NetStats.InBytesPerSec", #Budget), TestContext.GetNetStats().GetInBytesPerSecond(), static_cast<double>(Budget))) co_return; } while (0)
+#define UNTEST_ASSERT_NET_ACTORS_PER_FRAME_LE(Budget) do { if (!TestContext.Le(UNTEST_LINE_CONTEXT_ASSERT("NetStats.MaxReplicatedActorsPerFrame", #Budget), TestContext.GetNetStats().MaxReplicatedActorsPerFrame, static_cast<int32>(Budget))) co_return; } while (0)
+#define UNTEST_ASSERT_NET_REPLICATE_MS_PER_FRAME_LE(Budget) do { if (!TestContext.Le(UNTEST_LINE_CONTEXT_ASSERT("NetStats.MaxReplicateActorsMsPerFrame", #Budget), TestContext.GetNetStats().MaxReplicateActorsMsPerFrame, static_cast<double>(Budget))) co_return; } while (0)
+// clang-format on
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // You can derive directly from these fixtures if you want to override startup/shutdown and add
@@ -687,6 +966,9 @@ public:
 	// Should only be called on creation by the factory
 	void SetContext(TSharedPtr<FUntestContext> InContext);
 
+	// Null unless the fixture is a FUntestDedicatedServerTestFixture, whose server half can be served by another process
+	virtual FUntestDedicatedServerTestFixture* AsDedicatedServerFixture() { return nullptr; }
+
 	FUntestContext& GetContext() { return *FixtureContext; }
 
 	// Derived fixtures override these functions
@@ -713,6 +995,18 @@ public:
 	virtual UntestTask Run(FUntestContext& TestContext) = 0;
 };
 
+// Engine systems a World test's world is created with. Creating the physics scene, navigation, AI and audio usually
+// costs far more than a test that only spawns a few actors.
+enum class EUntestWorldProfile : uint32
+{
+	Bare,	  // Actors, ticking and timers only. No render or physics scene, navigation, AI, audio, FX or collision queries,
+			  // and world subsystems that only support Game and PIE worlds, which is the default, aren't created.
+	Gameplay, // Physics, collision and world subsystems, without navigation, AI, audio, FX or hit proxies
+	Full,	  // Everything a game world is created with
+};
+
+UNTESTED_API const TCHAR* UntestWorldProfileStr(EUntestWorldProfile Profile);
+
 struct UNTESTED_API FBVWorldTestFixture : public FUntestFixture
 {
 public:
@@ -726,6 +1020,30 @@ public:
 	virtual UntestTask RunFixture(const FString TestName) override;
 	virtual UntestTask TeardownFixture(const FString TestName) override;
 
+	// Worlds are pooled and reset between tests by default. A reset destroys spawned actors and components, clears
+	// timers and latent actions and resets time, but doesn't run BeginPlay again or undo property changes to actors
+	// that existed before the test, such as the world settings. Fixtures that change the world in ways a reset can't
+	// undo should return false to get a freshly created world for every test.
+	virtual bool CanReuseWorld() const { return true; }
+
+	// Worlds are only reused between fixtures that return the same key
+	virtual FString GetWorldPoolKey() const { return TEXT("Default"); }
+
+	// Fixtures whose tests don't need the whole engine should pick a leaner profile. Pooled worlds are only reused by
+	// fixtures with the same profile.
+	virtual EUntestWorldProfile GetWorldProfile() const { return EUntestWorldProfile::Full; }
+
+	// Fixtures whose Setup() does the same thing for every test can return a key to skip it. The world is snapshotted
+	// after the first Setup() with that key, and tests that get that world from the pool later have it restored to the
+	// snapshot instead: actors spawned since are destroyed, and the properties of every actor and component are reset to
+	// their saved values. State outside of actors, e.g. in subsystems, isn't snapshotted. Tests that destroy an actor
+	// or component from the snapshot get a fresh world, and Setup() runs again.
+	virtual FString GetSnapshotKey() const { return FString(); }
+
+	// Called instead of Setup() when the world was restored from a snapshot. Setup() usually stores pointers to what it
+	// spawned in the fixture, which is created anew for every test, so this is where to find them again.
+	virtual void OnRestoredFromSnapshot(FUntestContext& TestContext) {}
+
 	// Helper functions for making UObjects
 	template <typename T>
 	T* NewTestObject();
@@ -736,12 +1054,37 @@ public:
 	virtual UntestTask Run(FUntestContext& TestContext, const EUntestWorldType::Enum _WorldType) = 0;
 
 	void TeardownWorld();
+	void DestroyTestObjects();
+};
+
+// How often a ClientServer world ticks while the test runs
+struct FUntestTickRate
+{
+	float Hz = 0.0f;		// Ticks per second of real time, with a fixed delta of 1/Hz. 0 ticks once per fixture frame with the real delta.
+	int32 MaxSubsteps = 8;	// Most ticks run in one fixture frame to catch up. Any further ticks that were due are dropped.
+};
+
+// Replication waste audit for ClientServer tests, see FUntestReplicationAuditor in UntestReplicationAudit.h
+struct FUntestReplicationAuditOpts
+{
+	bool bEnabled = false;
+	int32 DormancyCandidateFrames = 60; // Server ticks an awake actor has to go without changes to be reported as a dormancy candidate
 };
 
+class UNetDriver;
+class UPendingNetGame;
+class UReplicationDriver;
+struct FURL;
+
 struct FUntestGameClasses
 {
 	TSubclassOf<UUntestGameInstance> GameInstanceClass;
 	TSubclassOf<AGameModeBase> GameModeClass;
+	TSubclassOf<UNetDriver> NetDriverClass; // Defaults to an in-memory loopback driver. Use UIpNetDriver to test over real sockets.
+
+	// Replaces the server's replication driver, e.g. a UReplicationGraph subclass. Defaults to whatever the NetDriver
+	// creates from the project's config. Graphs get RepGraph.* metrics with each connection's gather and prioritize time.
+	TSubclassOf<UReplicationDriver> ReplicationDriverClass;
 };
 
 struct UNTESTED_API FBVClientServerTestFixture : public FUntestFixture
@@ -756,12 +1099,60 @@ struct UNTESTED_API FBVClientServerTestFixture : public FUntestFixture
 	virtual UntestTask TeardownFixture(const FString TestName) override;
 	virtual UntestTask RunFixture(const FString TestName) override;
 
+	// Connected server/client pairs are pooled by game classes and reset between tests by default. Fixtures whose
+	// tests leave behind state that a reset can't undo should return false to get a fresh pair for every test.
+	virtual bool CanReuseClientServer() const { return true; }
+
+	// Resetting a pair only destroys the actors spawned during the test. Override this to restore state on actors
+	// that live across tests, such as player controllers. Called for the server before pending replication is
+	// flushed to the client, and for the client afterwards.
+	virtual void ResetClientServer(UWorld* World, const EUntestWorldType::Enum WorldType) {}
+
+	// Number of client worlds connected to the server. Run() is called once for the server and once for each client.
+	virtual int32 GetNumClients() const { return 1; }
+
+	// Network conditions to simulate while the test runs, e.g. { 50, 10, 2 } for 50ms latency with up to 10ms of jitter
+	// and 2% packet loss. Tests can change them with TestContext.SetNetProfile().
+	virtual FUntestNetProfile GetNetProfile() const { return FUntestNetProfile(); }
+
+	// Tick rate of each world, e.g. { 30.0f } for the server and { 120.0f } for clients to match production. A world
+	// set to a low rate runs slow relative to the others. Run() is resumed once after every tick of its own world.
+	virtual FUntestTickRate GetTickRate(const EUntestWorldType::Enum WorldType) const { return FUntestTickRate(); }
+
+	// Audits the server's replication while the test runs and reports properties compared or marked dirty without
+	// changing, and awake actors that could be dormant. Costs a copy and compare of every replicated property each tick.
+	virtual FUntestReplicationAuditOpts GetReplicationAuditOpts() const { return FUntestReplicationAuditOpts(); }
+
+	// Records the server's replication while the test runs to a replay with this name, for FUntestReplayTestFixture to
+	// play back. Recording tests always get fresh worlds, since the replay refers to them by the names they were created with.
+	virtual FString GetReplayRecordingName() const { return FString(); }
+
 	// Internal usage only
 	virtual FUntestGameClasses GetGameClasses() const { return FUntestGameClasses(); };
 	virtual UntestTask Run(FUntestContext& TestContext, const EUntestWorldType::Enum _WorldType) = 0;
 
 	// For fixture usage only
 	void TeardownClientServer();
+	void DestroyTestObjects();
+	void ResetContextWorlds();
+
+	// Steps of setting up a server or client world, shared with FUntestDedicatedServerTestFixture. Errors are added to
+	// the test context.
+	UWorld* CreateNetWorld(const FString& TestName, const EUntestWorldType::Enum WorldType, const FUntestGameClasses& Classes);
+	bool ListenNetWorld(UWorld* World, FURL& URL, const FUntestGameClasses& Classes, uint16& OutPort);
+	UPendingNetGame* BeginConnectNetWorld(UWorld* World, const FURL& URL, const FUntestGameClasses& Classes, FString& OutError);
+	void FinishConnectNetWorld(UWorld* World, UPendingNetGame* PendingNetGame);
+};
+
+// Connects NumClients client worlds to a single server world. Use with UNTEST_CLIENTSERVER_F() and tell the clients
+// apart with UNTEST_CLIENT_INDEX(). The server's tick time is recorded as metrics so tests with different client
+// counts show how server cost scales with connections.
+template <int32 NumClients>
+struct TUntestMultiClientFixture : public FBVClientServerTestFixture
+{
+	static_assert(NumClients > 0, "Need at least one client");
+
+	virtual int32 GetNumClients() const override { return NumClients; }
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
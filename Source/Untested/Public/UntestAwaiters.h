@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Untest.h"
+
+class AActor;
+class UWorld;
+
+// Awaitables that are woken by engine and game events, instead of predicates that search the world every frame. A
+// waiting test is still resumed once per frame, but only checks what the events collected since its last resume.
+
+// Counts triggers from a game or engine callback, e.g. an OnRep function, an RPC implementation or a delegate, so tests
+// can wait for it. Triggers are kept until they're waited for, so a test doesn't miss one that arrived before it started
+// waiting. Declared as a member of whatever owns the callback, which has to outlive any test waiting on it.
+struct FUntestSignal
+{
+	void Trigger()
+	{
+		++NumPending;
+		++NumTriggered;
+	}
+
+	// True if there's a trigger that hasn't been waited for yet
+	bool IsTriggered() const { return NumPending > 0; }
+
+	// Total triggers since construction or Reset(), including the ones already waited for
+	int32 GetNumTriggered() const { return NumTriggered; }
+
+	void Reset()
+	{
+		NumPending = 0;
+		NumTriggered = 0;
+	}
+
+	// Resumes once there's a trigger that hasn't been waited for yet, and takes it
+	UntestTask Wait()
+	{
+		co_await Squid::WaitUntil([this]()
+			{
+				return NumPending > 0;
+			});
+		--NumPending;
+	}
+
+private:
+	int32 NumPending = 0;
+	int32 NumTriggered = 0;
+};
+
+// Resumes once the world has Num actors of Class that passed Predicate, and returns them. Actors already in the world are
+// found with one search when the wait starts, later ones through the world's OnActorSpawned event. In worlds that have
+// begun play, actors are only considered after their BeginPlay(), which on clients is called once their initial
+// replicated properties have been applied, so this also waits for actors replicating to a client. Each actor is accepted
+// the first time it passes Predicate, and only actors that haven't been accepted yet are checked again. Returns an empty
+// array if the world is destroyed first.
+UNTESTED_API Squid::Task<TArray<AActor*>> UntestWaitForActorsOfClass(UWorld* World, UClass* Class, int32 Num, TFunction<bool(AActor*)> Predicate = nullptr);
+
+template <typename T>
+Squid::Task<TArray<T*>> UntestWaitForActors(UWorld* World, int32 Num, TFunction<bool(T*)> Predicate = nullptr)
+{
+	TFunction<bool(AActor*)> ActorPredicate;
+	if (Predicate)
+	{
+		ActorPredicate = [Predicate = MoveTemp(Predicate)](AActor* Actor)
+		{
+			return Predicate(static_cast<T*>(Actor));
+		};
+	}
+
+	const TArray<AActor*> Actors = co_await UntestWaitForActorsOfClass(World, T::StaticClass(), Num, MoveTemp(ActorPredicate));
+
+	TArray<T*> Result;
+	Result.Reserve(Actors.Num());
+	for (AActor* Actor : Actors)
+	{
+		Result.Add(static_cast<T*>(Actor));
+	}
+	co_return Result;
+}
+
+// Resumes once there's an actor of type T that passed Predicate, and returns it. Null if the world is destroyed first.
+template <typename T>
+Squid::Task<T*> UntestWaitForActor(UWorld* World, TFunction<bool(T*)> Predicate = nullptr)
+{
+	const TArray<T*> Actors = co_await UntestWaitForActors<T>(World, 1, MoveTemp(Predicate));
+	co_return Actors.IsEmpty() ? nullptr : Actors[0];
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Untest.h"
+
+#include "HAL/PlatformProcess.h"
+
+class FUntestControlChannel;
+
+struct FUntestDedicatedServerOpts
+{
+	FString ExtraArgs;					// Appended to the server process's command line, e.g. -ExecCmds="..." or -ini overrides
+	float ServerTickHz = 30.0f;			// The server process ticks at this fixed rate, like a real dedicated server
+	float StartTimeoutSeconds = 120.0f; // Time the process has to load the project, create its world and report back
+	float StopTimeoutSeconds = 10.0f;	// Time the process has to shut down after the test before it's killed
+};
+
+// Runs the server half of a ClientServer test in a separate dedicated server process, with the clients in this process
+// connecting to it over loopback sockets. In-process servers share the game thread, garbage collector and globals with
+// their clients, which hides the contention and serialization a real connection has. Here each side only pays for its
+// own work, so both sides' timings are realistic.
+//
+// Declare tests with UNTEST_CLIENTSERVER_F() as usual. Run() is called for the server in the server process, and for each
+// client here. The two halves can't share memory, so they can only synchronize through replication, and
+// TestContext.GetWorld(EUntestWorldType::Server) is null on the clients. Setup() and Teardown() run in both processes.
+//
+// The server process is this editor, started with -run=UntestServe. It connects back to the fixture over a TCP control
+// channel, creates the server world and reports the port it listens on. The clients then connect and log in, and the
+// fixture tells the server to start its Run(). Once it returns, the server sends back its errors, which fail the test,
+// and its metrics, which are recorded with a Server. prefix, including its ServerTickMs.*. The clients' tick time is
+// recorded as ClientTickMs.*.
+//
+// Net profiles, tick rates, the replication audit, replay recording and UNTEST_MAP() of FBVClientServerTestFixture aren't
+// supported.
+struct UNTESTED_API FUntestDedicatedServerTestFixture : public FBVClientServerTestFixture
+{
+	static float DefaultTimeoutMs() { return 180000.0f; } // Includes starting the server process
+
+	FUntestDedicatedServerTestFixture();
+	virtual ~FUntestDedicatedServerTestFixture();
+
+	virtual UntestTask SetupFixture(const FString TestName) override;
+	virtual UntestTask RunFixture(const FString TestName) override;
+	virtual UntestTask TeardownFixture(const FString TestName) override;
+
+	// Every test starts its own server process, so there's never a pair to reuse
+	virtual bool CanReuseClientServer() const override final { return false; }
+
+	virtual FUntestDedicatedServerOpts GetDedicatedServerOpts() const { return FUntestDedicatedServerOpts(); }
+
+	// Server process only, called by UUntestServeCommandlet
+	UntestTask ServeFixture(const FString TestName, uint16 ControlPort);
+	virtual FUntestDedicatedServerTestFixture* AsDedicatedServerFixture() override { return this; }
+
+private:
+	FUntestGameClasses GetResolvedGameClasses() const;
+	bool CreateServerWorld(const FString& TestName, uint16& OutPort);
+	UntestTask ConnectClientWorld(const FString TestName, const EUntestWorldType::Enum WorldType);
+	void ReceiveServerMessages();
+	void StopServerProcess();
+
+	TUniquePtr<FUntestControlChannel> ControlChannel;
+	FProcHandle ServerProcess;
+	uint16 ServerPort = 0;
+	bool bServerReady = false;	 // Listening, clients can connect
+	bool bServerRunDone = false; // Run() returned and its results were sent
+	bool bServerDone = false;	 // Torn down or failed to set up, about to exit
+};
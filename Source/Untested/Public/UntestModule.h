@@ -38,11 +38,48 @@ const TCHAR* UntestResultStr(EUntestResult Result);
 struct FUntestResults
 {
 	FUntestName TestName;
-	float DurationMs = 0.0;
+	float DurationMs = 0.0;	   // Wall clock time from the start of setup to the end of teardown
+	float CpuDurationMs = 0.0; // Thread CPU time spent while the test was actively running
 	EUntestResult Result = EUntestResult::Skipped;
 	TArray<FString> Errors;
+	TArray<FUntestMetric> Metrics; // Recorded by the test or its fixture with FUntestContext::AddMetric()
+	FUntestNetStats NetStats;	   // ClientServer tests only
+	EUntestReplicationSystem ReplicationSystem = EUntestReplicationSystem::Default;
 };
 
+// A ClientServer test's results under both replication systems, from a run with FUntestRunOpts::bCompareReplicationSystems
+struct FUntestReplicationComparison
+{
+	const FUntestResults* Generic = nullptr;
+	const FUntestResults* Iris = nullptr;
+
+	double GetOutBytesRatio() const;	   // Iris / generic bandwidth sent by the server. 0 if either didn't send anything.
+	double GetReplicateMsRatio() const;	   // Iris / generic server replication time per frame
+	bool HaveSameResult() const { return Generic->Result == Iris->Result; }
+};
+
+TArray<FUntestReplicationComparison> UntestCompareReplicationSystems(TArrayView<const FUntestResults> AllResults);
+
+// Clock used to measure elapsed test time for timeouts
+enum class EUntestTimeoutClock : uint32
+{
+	Wall,	   // Real time since the test started, including time spent waiting on other tests
+	ThreadCpu, // CPU time consumed only while the test's coroutine is resumed
+};
+
+const TCHAR* UntestTimeoutClockStr(EUntestTimeoutClock Clock);
+
+// When garbage left behind by destroyed test worlds is collected. Collections only run between tests.
+enum class EUntestGCPolicy : uint32
+{
+	EveryTest,		 // Full collection after every test that destroyed a world
+	EveryNTests,	 // Full collection once GCInterval tests have destroyed worlds
+	MemoryThreshold, // Full collection once used physical memory has grown by GCMemoryThresholdMB since the last one
+	Incremental,	 // Reachability analysis after every test that destroyed a world, purging spread across frames
+};
+
+const TCHAR* UntestGCPolicyStr(EUntestGCPolicy Policy);
+
 DECLARE_DELEGATE_OneParam(FBVOnTestStarted, const FUntestName& /*TestName*/);
 DECLARE_DELEGATE_OneParam(FBVOnTestComplete, const FUntestResults& /*Results*/);
 DECLARE_DELEGATE_OneParam(FBVOnAllTestsComplete, TArrayView<const FUntestResults> /*AllResults*/);
@@ -51,6 +88,16 @@ struct FUntestRunOpts
 {
 	bool bNoTimeouts = false;
 	bool bIncludeDisabled = false;
+	float TimeoutScale = 0.0f; // Multiplier applied to all test timeouts. <= 0 means calibrate it from the machine speed at run start.
+	EUntestTimeoutClock TimeoutClock = EUntestTimeoutClock::Wall;
+	bool bReuseWorlds = true; // World and ClientServer tests reset and reuse pooled worlds instead of creating new ones per test. Property changes to the world settings and other actors a test didn't spawn carry over.
+	EUntestGCPolicy GCPolicy = EUntestGCPolicy::EveryTest;
+	int32 GCInterval = 8;				// EveryNTests only
+	float GCMemoryThresholdMB = 512.0f; // MemoryThreshold only
+	float GCPurgeBudgetMs = 2.0f;		// Incremental only: time spent purging objects per tick
+	int32 MaxConcurrentNetTests = 1;	// ClientServer tests that may run at the same time, each with its own port and worlds
+	bool bCompareReplicationSystems = false; // ClientServer tests run once with the generic replication system, then again with Iris
+	bool bPipelineSetup = true; // World tests start setting up while the World test ahead of them runs
 	FBVOnTestStarted OnTestStarted;
 	FBVOnTestComplete OnTestComplete;
 	FBVOnAllTestsComplete OnAllTestsComplete;
@@ -75,6 +122,8 @@ public:
 	// For fixtures
 	static void RegisterFixture(const FUntestFixtureFactory& Factory);
 	static void UnregisterFixture(const FUntestFixtureFactory& Factory);
+	static void RegisterSuite(const FUntestSuiteFactory& Factory);
+	static void UnregisterSuite(const FUntestSuiteFactory& Factory);
 
 	// Find/Run test interface
 	TArray<FUntestInfo> FindTests(const FUntestSearchFilter& Filter);
@@ -83,20 +132,49 @@ public:
 	void StopTests();
 	TArrayView<const FUntestResults> GetResults() const;
 	bool WriteTestReport(const TCHAR* ReportPath) const;
+	float GetTimeoutScale() const { return TimeoutScale; }
+
+	// Creates a test's fixture without queueing it, for processes that run part of a test on behalf of the one running
+	// it, e.g. the server process of FUntestDedicatedServerTestFixture. Null if there's no test with that name.
+	TSharedPtr<FUntestFixture> NewFixture(const FString& FullTestName, EUntestReplicationSystem System) const;
+
+	// Runs a short fixed CPU workload and returns how much slower this machine is than the machine the
+	// default timeouts were tuned on. Never returns less than 1.
+	static float CalibrateTimeoutScale();
+
+	// Orders full test names so each suite's tests run back to back, the way queued tests are run
+	static void GroupBySuite(TArray<FString>& TestNames);
 
 private:
 	using FTestFactoryMap = TMap<FString, const FUntestFixtureFactory*>;
+	using FSuiteFactoryMap = TMap<FString, const FUntestSuiteFactory*>;
 
 	UntestTask RunTest(TSharedPtr<FUntestFixture> Fixture);
+	UntestTask SetupSuite(FUntestContext& Context);
+	void TeardownFinishedSuites();
+	void ReportLeaks();
+	bool CanStartNextTest() const;
+	bool CanPipelineNextTest() const;
+	void PreloadQueuedMaps() const;
+	void SetReplicationSystem(EUntestReplicationSystem System);
 	static FTestFactoryMap& GetTestFactories();
+	static FSuiteFactoryMap& GetSuiteFactories();
 
 	static FTestFactoryMap* TestFactories;
+	static FSuiteFactoryMap* SuiteFactories;
 
 	FUntestRunOpts RunOpts;
+	float TimeoutScale = 1.0f;
 	TArray<FString> QueuedTests;
 	TArray<FUntestResults> TestResults;
 	TArray<TSharedPtr<FUntestFixture>> RunningTests;
 	TArray<TSharedPtr<FUntestFixture>> StoppingTests;
+	TMap<FString, TSharedPtr<FUntestSuite>> ActiveSuites; // Suites that have tests running or queued next
+
+	// Replication system comparison: ClientServer tests queued again once the generic pass has finished
+	EUntestReplicationSystem ReplicationSystem = EUntestReplicationSystem::Default;
+	TArray<FString> IrisPassTests;
+	TOptional<int32> ProjectUseIrisReplication; // The cvar's value before the run changed it
 
 	TUniquePtr<FUntestUI> UI;
 };
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Untest.h"
+
+#include "Math/RandomStream.h"
+#include "UObject/Class.h"
+
+struct FUntestNetSerializeFuzzOpts
+{
+	int32 Iterations = 10000;
+	int32 Seed = 0;				 // 0 derives it from the test name. The seed used is recorded as the NetSerialize.Seed metric.
+	float MutatePercent = 50.0f; // Values made by re-randomizing one property of the previous value instead of all of them
+	double FloatRange = 100000.0; // Random floats are within +-FloatRange. Integers span their type's full range.
+	int32 MaxStringLength = 32;
+	int32 MaxArrayNum = 8;
+	int32 MaxReportedFailures = 10; // Failures past this are only counted
+	bool bParallel = true;			// Splits the iterations across worker threads. Turn off for NetSerialize() implementations that aren't thread-safe.
+};
+
+struct FUntestNetSerializeFuzzResults
+{
+	int32 Values = 0;
+	int32 Failures = 0;
+	int64 MinBits = 0;
+	int64 MaxBits = 0;
+	double AvgBits = 0.0;
+	int32 NativeBits = 0; // Size of the struct in memory, to compare the serialized size against
+	double AvgWriteNs = 0.0;
+	double AvgReadNs = 0.0;
+};
+
+struct FUntestNetSerializeFuzzCallbacks
+{
+	TFunction<void(void* /*Value*/, FRandomStream& /*Random*/)> Generate;
+	TFunction<void(void* /*Value*/, FRandomStream& /*Random*/)> Mutate;
+	TFunction<bool(const void* /*Original*/, const void* /*RoundTripped*/)> IsEquivalent;
+};
+
+// Sets every bool, numeric, enum, string, name, struct and array property of Value to a random value. Object references,
+// maps, sets and text are left alone.
+UNTESTED_API void UntestRandomizeStruct(const UScriptStruct* Struct, void* Value, FRandomStream& Random, const FUntestNetSerializeFuzzOpts& Opts);
+
+// Re-randomizes a single property, picked at random. Struct properties pick one of their own properties in turn.
+UNTESTED_API void UntestMutateStruct(const UScriptStruct* Struct, void* Value, FRandomStream& Random, const FUntestNetSerializeFuzzOpts& Opts);
+
+// Round-trips Opts.Iterations values through the struct's NetSerialize(), adds an error for each value that doesn't
+// survive it and records NetSerialize.* metrics. See TUntestNetSerializeFuzzFixture.
+UNTESTED_API FUntestNetSerializeFuzzResults UntestFuzzNetSerialize(FUntestContext& TestContext, const UScriptStruct* Struct, const FUntestNetSerializeFuzzOpts& Opts, const FUntestNetSerializeFuzzCallbacks& Callbacks);
+
+// Fuzzes a USTRUCT's custom NetSerialize() with random and mutated values. Each value is written with an FNetBitWriter and
+// read back with an FNetBitReader, which has to succeed, consume exactly the bits that were written and give back a value
+// IsEquivalent() to the original. The value read back is then round-tripped again and has to come back unchanged, so
+// quantizing structs are checked for losing precision only once. Records these NetSerialize.* metrics:
+//   Values, Seed:             values checked and the seed that generated them, to reproduce a failure with Opts.Seed
+//   Bits.Avg/Min/Max:         serialized size of each value
+//   NativeBits:               size of the struct in memory, the size a plain replicated struct would start from
+//   WriteNs.Avg, ReadNs.Avg:  time spent in NetSerialize() per value
+//
+// Declare tests with UNTEST_UNIT_F_OPTS(..., UNTEST_PURE()) so they start alongside other pure tests. Run() is called
+// after fuzzing, and can check GetFuzzResults() against a bandwidth budget. There's no package map, so structs that
+// serialize object references aren't supported. NetDeltaSerialize() needs a connection's replication state, so fast
+// arrays and other delta serialized structs are best covered by ClientServer tests.
+template <typename StructType>
+struct TUntestNetSerializeFuzzFixture : public FBVUnitTestFixture
+{
+	static_assert(TStructOpsTypeTraits<StructType>::WithNetSerializer, "Fuzzed structs need a NetSerialize() with WithNetSerializer set in their TStructOpsTypeTraits");
+
+	static float DefaultTimeoutMs() { return 10000.0f; }
+
+	virtual FUntestNetSerializeFuzzOpts GetFuzzOpts() const { return FUntestNetSerializeFuzzOpts(); }
+
+	// Structs whose NetSerialize() only takes part of each property's range, e.g. normalized vectors, override these two
+	// to stay within it
+	virtual void GenerateValue(StructType& Value, FRandomStream& Random) const { UntestRandomizeStruct(StructType::StaticStruct(), &Value, Random, FuzzOpts); }
+	virtual void MutateValue(StructType& Value, FRandomStream& Random) const { UntestMutateStruct(StructType::StaticStruct(), &Value, Random, FuzzOpts); }
+
+	// Lossy structs override this with their tolerance
+	virtual bool IsEquivalent(const StructType& Original, const StructType& RoundTripped) const
+	{
+		return StructType::StaticStruct()->CompareScriptStruct(&Original, &RoundTripped, PPF_None);
+	}
+
+	const FUntestNetSerializeFuzzResults& GetFuzzResults() const { return FuzzResults; }
+
+	virtual UntestTask RunFixture(const FString TestName) override
+	{
+		FuzzOpts = GetFuzzOpts();
+
+		FUntestNetSerializeFuzzCallbacks Callbacks;
+		Callbacks.Generate = [this](void* Value, FRandomStream& Random)
+		{
+			GenerateValue(*static_cast<StructType*>(Value), Random);
+		};
+		Callbacks.Mutate = [this](void* Value, FRandomStream& Random)
+		{
+			MutateValue(*static_cast<StructType*>(Value), Random);
+		};
+		Callbacks.IsEquivalent = [this](const void* Original, const void* RoundTripped)
+		{
+			return IsEquivalent(*static_cast<const StructType*>(Original), *static_cast<const StructType*>(RoundTripped));
+		};
+
+		FuzzResults = UntestFuzzNetSerialize(GetContext(), StructType::StaticStruct(), FuzzOpts, Callbacks);
+
+		co_await Run(GetContext());
+	}
+
+protected:
+	FUntestNetSerializeFuzzOpts FuzzOpts;
+
+private:
+	FUntestNetSerializeFuzzResults FuzzResults;
+};
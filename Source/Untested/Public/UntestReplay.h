@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Untest.h"
+
+class UDemoNetDriver;
+
+struct FUntestReplayOpts
+{
+	FString ReplayName;					 // Returned by the recording fixture's GetReplayRecordingName()
+	FString RecordedTestName;			 // Full name of the ClientServer test that recorded it, e.g. Game.Net.MoveAndShoot
+	float StepSeconds = 1.0f / 30.0f;	 // Replay time advanced by each tick, independent of how long the tick took
+	float MaxFrameMs = 50.0f;			 // Playback ticks run back to back for up to this long before yielding to the test runner
+	int32 MaxLoadTicks = 600;			 // Ticks to wait for the replay to finish loading before failing the test
+};
+
+// Plays a replay recorded by a ClientServer test back into a lone client world, so client-side receive and OnRep cost
+// can be benchmarked without a server running alongside it. Record with a ClientServer fixture that returns a name from
+// GetReplayRecordingName(), in an earlier run or earlier in the same one, then declare the playback test with
+// UNTEST_WORLD_F(). Run() is resumed after every playback tick, and the test ends once the replay has played to the end
+// and Run() has returned. Records Replay.* metrics:
+//   Ticks, DemoSeconds:  playback ticks and the replay time they covered
+//   TickMs.Avg/Max:      client world tick time, which includes receiving and applying the recorded packets
+//   Speedup:             replay time played per second of real time
+//
+// The world takes the names the recording server's world had, minus the PIE prefix, so the replay's level and actor
+// paths resolve to it the same way they do for a live client.
+struct UNTESTED_API FUntestReplayTestFixture : public FBVWorldTestFixture
+{
+	static float DefaultTimeoutMs() { return 60000.0f; }
+
+	virtual ~FUntestReplayTestFixture();
+
+	virtual FUntestReplayOpts GetReplayOpts() const = 0;
+
+	virtual UntestTask SetupFixture(const FString TestName) override;
+	virtual UntestTask RunFixture(const FString TestName) override;
+	virtual UntestTask TeardownFixture(const FString TestName) override;
+
+	UDemoNetDriver* GetDemoNetDriver();
+
+private:
+	void DestroyReplayWorld();
+
+	FString ReplayTestName;
+	FName PackageName;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Untest.h"
+
+#include "Net/Core/PushModel/PushModel.h"
+
+// Replication waste found in one replicated property, summed over the audited class's actors
+struct FUntestReplicationAuditProperty
+{
+	FName Name;
+	bool bPushModel = false;
+	int64 WastedComparisons = 0; // Compared while its actor replicated, without having changed. Push model properties are only compared when dirty, so they never count.
+	int64 DirtyUnchanged = 0;	 // Marked dirty with UNTEST_MARK_PROPERTY_DIRTY_FROM_NAME() without having changed
+};
+
+struct FUntestReplicationAuditClass
+{
+	int32 Actors = 0;			  // Seen by the audit over the whole test
+	int32 DormancyCandidates = 0; // Awake actors that went FUntestReplicationAuditOpts::DormancyCandidateFrames without any property changing
+	int64 WastedComparisons = 0;
+	int64 DirtyUnchanged = 0;
+	TArray<FUntestReplicationAuditProperty> Properties;
+
+	bool HasWaste() const { return DormancyCandidates > 0 || WastedComparisons > 0 || DirtyUnchanged > 0; }
+};
+
+// Finds replication work on the server that never changes anything. Enabled with the fixture's GetReplicationAuditOpts()
+// and sampled after every server tick, it keeps a copy of each replicated property of every replicated actor and
+// compares it to the live value. Results are recorded as ReplicationAudit.<Class>.* metrics when the test finishes,
+// and can be checked by the test with the UNTEST_*_REPLICATION_* macros below.
+class UNTESTED_API FUntestReplicationAuditor
+{
+public:
+	FUntestReplicationAuditor(UWorld* InServerWorld, const FUntestReplicationAuditOpts& InOpts);
+	~FUntestReplicationAuditor();
+
+	FUntestReplicationAuditor(const FUntestReplicationAuditor&) = delete;
+	FUntestReplicationAuditor& operator=(const FUntestReplicationAuditor&) = delete;
+
+	void Sample();
+	void RecordMetrics(FUntestContext& TestContext) const;
+
+	// Summed over Class and all of its subclasses
+	FUntestReplicationAuditClass GetTotals(const UClass* Class) const;
+
+	// Use UNTEST_MARK_PROPERTY_DIRTY_FROM_NAME() instead
+	static void NotifyPropertyDirty(const UObject* Object, FName PropertyName);
+
+private:
+	struct FAuditedProperty
+	{
+		FProperty* Property = nullptr;
+		int32 ArrayIndex = 0;
+		int32 StatIndex = 0; // Into FUntestReplicationAuditClass::Properties
+		bool bPushModel = false;
+	};
+
+	struct FPropertyShadow;
+	struct FActorState;
+
+	const TArray<FAuditedProperty>& GetAuditedProperties(const UClass* Class);
+	void SampleActor(AActor* Actor, double LastNetReplicateTime);
+
+	TWeakObjectPtr<UWorld> ServerWorld;
+	FUntestReplicationAuditOpts Opts;
+
+	TMap<const UClass*, TArray<FAuditedProperty>> ClassProperties;
+	TMap<const UClass*, FUntestReplicationAuditClass> ClassResults;
+	TMap<TWeakObjectPtr<AActor>, TUniquePtr<FActorState>> ActorStates;
+	TMap<TWeakObjectPtr<const UObject>, TArray<FName>> PendingDirtyMarks; // Since the last sample
+};
+
+// Records the dirty mark for the audit, then marks the property dirty as MARK_PROPERTY_DIRTY_FROM_NAME() does. The engine
+// doesn't expose push model dirty state, so this is the only way the audit can see dirty marks. Game modules can only
+// depend on Untested in editor builds, so wrap uses in #if WITH_EDITOR or a project macro that falls back to
+// MARK_PROPERTY_DIRTY_FROM_NAME().
+#define UNTEST_MARK_PROPERTY_DIRTY_FROM_NAME(ClassName, PropertyName, Object)                                 \
+	do                                                                                                         \
+	{                                                                                                          \
+		FUntestReplicationAuditor::NotifyPropertyDirty(Object, GET_MEMBER_NAME_CHECKED(ClassName, PropertyName)); \
+		MARK_PROPERTY_DIRTY_FROM_NAME(ClassName, PropertyName, Object);                                        \
+	} while (0)
+
+UNTESTED_API FUntestReplicationAuditClass UntestGetReplicationAudit(FUntestContext& TestContext, const UClass* Class);
+
+// Audit checks for ClientServer tests, e.g. UNTEST_EXPECT_REPLICATION_WASTED_COMPARISONS_LE(AMyActor, 0). Each counts
+// ActorClass and its subclasses since the test started. The fixture must enable the audit in GetReplicationAuditOpts().
+// clang-format off
+#define UNTEST_EXPECT_REPLICATION_WASTED_COMPARISONS_LE(ActorClass, Budget) (void)TestContext.Le(UNTEST_LINE_CONTEXT_EXPECT("ReplicationAudit." #ActorClass ".WastedComparisons", #Budget), UntestGetReplicationAudit(TestContext, ActorClass::StaticClass()).WastedComparisons, static_cast<int64>(Budget))
+#define UNTEST_EXPECT_REPLICATION_DIRTY_UNCHANGED_LE(ActorClass, Budget) (void)TestContext.Le(UNTEST_LINE_CONTEXT_EXPECT("ReplicationAudit." #ActorClass ".DirtyUnchanged", #Budget), UntestGetReplicationAudit(TestContext, ActorClass::StaticClass()).DirtyUnchanged, static_cast<int64>(Budget))
+#define UNTEST_EXPECT_REPLICATION_DORMANCY_CANDIDATES_LE(ActorClass, Budget) (void)TestContext.Le(UNTEST_LINE_CONTEXT_EXPECT("ReplicationAudit." #ActorClass ".DormancyCandidates", #Budget), UntestGetReplicationAudit(TestContext, ActorClass::StaticClass()).DormancyCandidates, static_cast<int32>(Budget))
+
+#define UNTEST_ASSERT_REPLICATION_WASTED_COMPARISONS_LE(ActorClass, Budget) do { if (!TestContext.Le(UNTEST_LINE_CONTEXT_ASSERT("ReplicationAudit." #ActorClass ".WastedComparisons", #Budget), UntestGetReplicationAudit(TestContext, ActorClass::StaticClass()).WastedComparisons, static_cast<int64>(Budget))) co_return; } while (0)
+#define UNTEST_ASSERT_REPLICATION_DIRTY_UNCHANGED_LE(ActorClass, Budget) do { if (!TestContext.Le(UNTEST_LINE_CONTEXT_ASSERT("ReplicationAudit." #ActorClass ".DirtyUnchanged", #Budget), UntestGetReplicationAudit(TestContext, ActorClass::StaticClass()).DirtyUnchanged, static_cast<int64>(Budget))) co_return; } while (0)
+#define UNTEST_ASSERT_REPLICATION_DORMANCY_CANDIDATES_LE(ActorClass, Budget) do { if (!TestContext.Le(UNTEST_LINE_CONTEXT_ASSERT("ReplicationAudit." #ActorClass ".DormancyCandidates", #Budget), UntestGetReplicationAudit(TestContext, ActorClass::StaticClass()).DormancyCandidates, static_cast<int32>(Budget))) co_return; } while (0)
+// clang-format on
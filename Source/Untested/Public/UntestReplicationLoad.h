@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Untest.h"
+
+#include "GameFramework/Actor.h"
+#include "UntestReplicationLoad.generated.h"
+
+// Replicated actor spawned in bulk by FUntestReplicationLoadFixture. It doesn't tick; the fixture changes its
+// properties directly so the churn rate is exactly what was asked for.
+UCLASS(NotPlaceable, Transient)
+class UNTESTED_API AUntestReplicationLoadActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AUntestReplicationLoadActor();
+
+	// Changes every replicated property, as a gameplay update to the actor would
+	void Churn();
+
+	UPROPERTY(Replicated)
+	int32 Counter = 0;
+
+	UPROPERTY(Replicated)
+	float Value = 0.0f;
+
+	UPROPERTY(Replicated)
+	FVector Position = FVector::ZeroVector;
+};
+
+struct FUntestReplicationLoadOpts
+{
+	TArray<int32> ActorCounts = { 100, 1000, 10000 }; // Steps of the scaling curve, in increasing order
+	float ChurnPercent = 10.0f;						  // Actors whose properties change every server tick
+	bool bDormant = false;							  // Actors are dormant and only flushed when they change
+	int32 WarmupTicks = 10;							  // Server ticks between the clients having every actor and measuring
+	int32 MeasureTicks = 60;						  // Server ticks measured for each step
+	int32 MaxSpawnWaitTicks = 1800;					  // Server ticks to wait for the clients to receive a step's new actors
+};
+
+// Benchmarks replication cost as the number of replicated actors grows. Use with UNTEST_CLIENTSERVER_F() and call
+// co_await RunReplicationLoad(TestContext, _WorldType) from the test. For every step the server spawns actors up to the
+// step's count, waits for all clients to receive them, then records ReplicationLoad.<Count>.* metrics:
+//   ServerReplicateMsPerTick: time in the server's ServerReplicateActors(), or with Iris its NetDriver's TickFlush()
+//   ClientReceiveMsPerTick:   time each client spends receiving packets, averaged over clients
+//   OutBytesPerTick:          bytes the server sends to all clients
+// Both times come from the loopback NetDriver, so they're 0 for fixtures that pick another one.
+struct UNTESTED_API FUntestReplicationLoadFixture : public FBVClientServerTestFixture
+{
+	static float DefaultTimeoutMs() { return 120000.0f; }
+
+	virtual FUntestReplicationLoadOpts GetReplicationLoadOpts() const { return FUntestReplicationLoadOpts(); }
+
+	UntestTask RunReplicationLoad(FUntestContext& TestContext, const EUntestWorldType::Enum WorldType);
+
+private:
+	UntestTask RunServerLoad(FUntestContext& TestContext);
+	void ChurnActors(float ChurnPercent, bool bDormant);
+	int32 CountClientActors(FUntestContext& TestContext) const;
+
+	TArray<TWeakObjectPtr<AUntestReplicationLoadActor>> Actors;
+	int32 NextChurnIndex = 0;
+};
@@ -16,8 +16,12 @@ public class Untested : ModuleRules
 		PrivateDependencyModuleNames.AddRange(new string[] {
 			"ApplicationCore",
 			"InputCore",
+			"NetCore",
+			"PacketHandler",
+			"ReplicationGraph",
 			"Slate",
 			"SlateCore",
+			"Sockets",
 			"UnrealEd",
 			"WorkspaceMenuStructure",
 		});